@@ -0,0 +1,447 @@
+// Microbenchmarks de AlarmManager, AlarmStorage, AlarmCodec, Resources y
+// AlarmId.
+//
+//   wake_bench [--sizes 10,1000,...] [--max N] [--dir RUTA] [--out FICHERO]
+//
+// Para cada N crea N alarmas en un directorio temporal (nunca toca los
+// datos reales) y mide ns/op, asignaciones por op (del hilo que mide) y
+// bytes escritos a disco por op, además de cuánto crece la memoria
+// residente por op (en create, lo que ocupa cada alarma en el servidor).
+// En storage_* y journal_replay la operación es una alarma. El resultado sale en JSON por stdout (o en
+// --out) para comparar dos builds; el resumen legible va por stderr.
+#include "core/AlarmManager.h"
+#include "core/AudioBackend.h"
+#include "models/AlarmStorage.h"
+#include "models/AlarmCodec.h"
+#include "utils/Logger.h"
+#include <resources.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+// Sólo las del hilo que mide: el writer del log y el worker de audio no cuentan
+thread_local uint64_t t_allocations = 0;
+
+}
+
+void* operator new(std::size_t size) {
+    t_allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+using json = nlohmann::json;
+using SteadyClock = std::chrono::steady_clock;
+
+struct Result {
+    std::string name;
+    size_t n = 0;            // alarmas existentes (0: no depende de N)
+    size_t iterations = 0;
+    double ns_per_op = 0;
+    double allocs_per_op = 0;
+    double bytes_written_per_op = 0;
+    double rss_bytes_per_op = 0;
+};
+
+std::vector<Result> results;
+
+// Memoria residente del proceso, en bytes
+uint64_t residentBytes() {
+    unsigned long long size = 0, resident = 0;
+    if (FILE* statm = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(statm, "%llu %llu", &size, &resident) != 2) resident = 0;
+        std::fclose(statm);
+    }
+    return resident * static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+}
+
+// Ejecuta body (que hace las `iterations` operaciones) y guarda el resultado;
+// bytes_written devuelve los bytes escritos a disco hasta el momento
+template <typename Body, typename BytesWritten>
+void measure(const std::string& name, size_t n, size_t iterations,
+             Body&& body, BytesWritten&& bytes_written) {
+    uint64_t bytes_before = bytes_written();
+    uint64_t allocs_before = t_allocations;
+    uint64_t rss_before = residentBytes();
+    auto started = SteadyClock::now();
+
+    body();
+
+    auto elapsed = std::chrono::duration<double, std::nano>(SteadyClock::now() - started).count();
+    uint64_t allocs = t_allocations - allocs_before;
+    uint64_t bytes = bytes_written() - bytes_before;
+    // Puede bajar si body() libera más de lo que reserva
+    double rss = static_cast<double>(residentBytes()) - static_cast<double>(rss_before);
+
+    Result result;
+    result.name = name;
+    result.n = n;
+    result.iterations = iterations;
+    result.ns_per_op = elapsed / static_cast<double>(iterations);
+    result.allocs_per_op = static_cast<double>(allocs) / static_cast<double>(iterations);
+    result.bytes_written_per_op = static_cast<double>(bytes) / static_cast<double>(iterations);
+    result.rss_bytes_per_op = rss / static_cast<double>(iterations);
+    results.push_back(result);
+
+    std::fprintf(stderr, "  %-18s n=%-8zu %12.1f ns/op %10.2f allocs/op %10.1f B/op %10.1f B rss/op\n",
+                 name.c_str(), n, result.ns_per_op, result.allocs_per_op,
+                 result.bytes_written_per_op, result.rss_bytes_per_op);
+}
+
+template <typename Body>
+void measure(const std::string& name, size_t n, size_t iterations, Body&& body) {
+    measure(name, n, iterations, std::forward<Body>(body), [] { return uint64_t(0); });
+}
+
+void removeDataFiles(const std::string& base) {
+    for (const char* ext : {".snap", ".snap.tmp", ".journal", ".journal.old", ".json"}) {
+        ::unlink((base + ext).c_str());
+    }
+}
+
+Alarm makeAlarm(size_t i) {
+    Alarm alarm;
+    alarm.id = AlarmId(i + 1);
+    alarm.hour = static_cast<uint8_t>(i % 24);
+    alarm.minute = static_cast<uint8_t>((i / 24) % 60);
+    alarm.label = "Alarma " + std::to_string(i);
+    alarm.enabled = (i % 3 != 0);
+    alarm.vibrate = true;
+    alarm.sound_file = "default";
+    return alarm;
+}
+
+void benchManager(const std::string& dir, size_t n) {
+    const std::string base = dir + "/manager";
+    removeDataFiles(base);
+
+    AlarmManager::Options options;
+    options.storage_path = base;
+    options.audio_backend = std::make_shared<NullAudioBackend>();
+
+    // Las operaciones por id se repiten sobre como mucho `sample` alarmas
+    const size_t sample = std::min<size_t>(n, 100000);
+    std::vector<std::string> ids;
+    ids.reserve(n);
+
+    {
+        AlarmManager manager(options);
+        auto written = [&manager] { return manager.getStorageStats().bytes; };
+
+        measure("create", n, n, [&] {
+            for (size_t i = 0; i < n; i++) {
+                ids.push_back(manager.createAlarm(static_cast<int>(i % 24),
+                                                  static_cast<int>((i / 24) % 60),
+                                                  "Alarma " + std::to_string(i), true, "default"));
+            }
+            manager.flush();
+        }, written);
+
+        measure("toggle", n, sample, [&] {
+            for (size_t i = 0; i < sample; i++) {
+                manager.toggleAlarm(ids[i]);
+            }
+            manager.flush();
+        }, written);
+
+        const size_t reads = std::max<size_t>(1, std::min<size_t>(1000, 100000 / n));
+        measure("get_all_alarms", n, reads, [&] {
+            for (size_t i = 0; i < reads; i++) {
+                nlohmann::json list = manager.getAllAlarms();
+                if (list.size() != n) std::abort();
+            }
+        });
+
+        manager.flush();
+    }
+
+    // Arranque sin snapshot: se reproduce el journal completo
+    measure("journal_replay", n, n, [&] {
+        AlarmManager manager(options);
+    });
+
+    {
+        AlarmManager manager(options);
+        auto written = [&manager] { return manager.getStorageStats().bytes; };
+
+        measure("delete", n, sample, [&] {
+            for (size_t i = 0; i < sample; i++) {
+                manager.deleteAlarm(ids[i]);
+            }
+            manager.flush();
+        }, written);
+    }
+
+    removeDataFiles(base);
+}
+
+void benchStorage(const std::string& dir, size_t n) {
+    const std::string base = dir + "/storage";
+    removeDataFiles(base);
+
+    std::vector<Alarm> alarms;
+    alarms.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        alarms.push_back(makeAlarm(i));
+    }
+
+    {
+        AlarmStorage storage(base);
+        storage.load();
+        auto written = [&storage] { return storage.stats().bytes; };
+
+        // Umbral 1: el siguiente commit compacta y escribe el snapshot con las N
+        storage.start([&alarms] { return alarms; }, 1);
+        measure("storage_snapshot", n, n, [&] {
+            storage.appendPut(alarms.front());
+            storage.flush();
+        }, written);
+        storage.stop();
+    }
+
+    measure("storage_load", n, n, [&] {
+        AlarmStorage storage(base);
+        if (storage.load().size() != n) std::abort();
+    });
+
+    removeDataFiles(base);
+}
+
+void benchResources() {
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < Resources::RESOURCE_COUNT; i++) {
+        paths.emplace_back(Resources::RESOURCES[i].path);
+    }
+    paths.emplace_back("/no/existe.js");
+
+    const size_t lookups = 1000000;
+    size_t found = 0;
+    measure("resources_get", 0, lookups, [&] {
+        for (size_t i = 0; i < lookups; i++) {
+            if (Resources::getResource(paths[i % paths.size()]) != nullptr) found++;
+        }
+    });
+    if (found == 0 && paths.size() > 1) std::abort();
+}
+
+void benchAlarmId() {
+    const size_t count = 100000;
+    size_t length = 0;
+    std::string text;
+    measure("generate_id", 0, count, [&] {
+        for (size_t i = 0; i < count; i++) {
+            text.clear();
+            AlarmId::generate().appendTo(text);
+            length += text.size();
+        }
+    });
+    if (length == 0) std::abort();
+}
+
+// AlarmCodec frente a nlohmann::json con lo mismo que hacen POST
+// /api/alarms (cuerpo -> campos) y el journal / la lista (alarma -> JSON)
+void benchCodec() {
+    // La regla de repetición la sigue validando Recurrence::fromJson (con
+    // nlohmann): sin ella se ve el coste del parser en sí
+    const std::string body =
+        "{\"hour\":7,\"minute\":30,\"label\":\"Despertar \\u00e1\",\"vibrate\":true,"
+        "\"sound_file\":\"default\"}";
+    const std::string body_repeat = body.substr(0, body.size() - 1) +
+        ",\"repeat\":{\"type\":\"weekly\",\"weekdays\":[1,2,3,4,5]}}";
+    const size_t count = 100000;
+    size_t checksum = 0;
+
+    for (const std::string* input : {&body, &body_repeat}) {
+        const std::string suffix = (input == &body) ? "" : "_repeat";
+
+        measure("json_parse" + suffix + "_nlohmann", 0, count, [&] {
+            for (size_t i = 0; i < count; i++) {
+                json parsed = json::parse(*input);
+                Recurrence repeat;
+                std::string error;
+                if (parsed.contains("repeat") && !Recurrence::fromJson(parsed["repeat"], repeat, error)) {
+                    std::abort();
+                }
+                int hour = parsed["hour"];
+                std::string label = parsed.value("label", "Alarma");
+                checksum += static_cast<size_t>(hour) + label.size() + repeat.weekdays;
+            }
+        });
+
+        measure("json_parse" + suffix + "_codec", 0, count, [&] {
+            for (size_t i = 0; i < count; i++) {
+                AlarmFields fields;
+                std::string error;
+                if (!AlarmCodec::parse(*input, fields, nullptr, error)) std::abort();
+                checksum += static_cast<size_t>(*fields.hour) + fields.label->size() +
+                            (fields.repeat ? fields.repeat->weekdays : 0);
+            }
+        });
+    }
+
+    Alarm alarm = makeAlarm(12345);
+    std::string error;
+    Recurrence repeat;
+    Recurrence::fromJson(json::parse(R"({"type":"weekly","weekdays":[1,2,3,4,5]})"), repeat, error);
+    alarm.repeat = repeat;
+
+    measure("json_write_nlohmann", 0, count, [&] {
+        for (size_t i = 0; i < count; i++) {
+            json item;
+            item["id"] = alarm.id.toString();
+            item["hour"] = alarm.hour;
+            item["minute"] = alarm.minute;
+            item["label"] = alarm.label.get();
+            item["enabled"] = alarm.enabled;
+            item["vibrate"] = alarm.vibrate;
+            item["sound_file"] = alarm.sound_file.get();
+            item["repeat"] = alarm.repeat->toJson();
+            checksum += item.dump().size();
+        }
+    });
+
+    std::string out;
+    measure("json_write_codec", 0, count, [&] {
+        for (size_t i = 0; i < count; i++) {
+            out.clear();
+            AlarmCodec::appendObject(out, alarm, AlarmCodec::FIELDS);
+            checksum += out.size();
+        }
+    });
+
+    if (checksum == 0) std::abort();
+}
+
+std::vector<size_t> parseSizes(const std::string& text) {
+    std::vector<size_t> sizes;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find(',', start);
+        if (end == std::string::npos) end = text.size();
+        size_t value = std::strtoull(text.substr(start, end - start).c_str(), nullptr, 10);
+        if (value > 0) sizes.push_back(value);
+        start = end + 1;
+    }
+    return sizes;
+}
+
+void usage() {
+    std::cerr << "Uso: wake_bench [--sizes 10,100,...] [--max N] [--dir RUTA] [--out FICHERO]\n";
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes = {10, 100, 1000, 10000, 100000, 1000000};
+    size_t max_size = 0;
+    std::string dir;
+    std::string out_path;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 2;
+        }
+        if (arg == "--sizes") {
+            sizes = parseSizes(argv[++i]);
+        } else if (arg == "--max") {
+            max_size = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--dir") {
+            dir = argv[++i];
+        } else if (arg == "--out") {
+            out_path = argv[++i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (max_size > 0) {
+        sizes.erase(std::remove_if(sizes.begin(), sizes.end(),
+                                   [max_size](size_t n) { return n > max_size; }),
+                    sizes.end());
+    }
+
+    bool temporary_dir = dir.empty();
+    if (temporary_dir) {
+        char pattern[] = "/tmp/wake_bench.XXXXXX";
+        if (::mkdtemp(pattern) == nullptr) {
+            std::perror("mkdtemp");
+            return 1;
+        }
+        dir = pattern;
+    }
+
+    // Cada alarma creada se registra: sólo interesan los avisos
+    Logger::setConsole(false);
+    Logger::setLevel(Logger::Level::Warning);
+
+    std::fprintf(stderr, "wake_bench en %s\n", dir.c_str());
+    benchResources();
+    benchAlarmId();
+    benchCodec();
+    for (size_t n : sizes) {
+        std::fprintf(stderr, "N = %zu\n", n);
+        benchManager(dir, n);
+        benchStorage(dir, n);
+    }
+
+    if (temporary_dir) {
+        ::rmdir(dir.c_str());
+    }
+
+    json report;
+#ifdef NDEBUG
+    report["optimized"] = true;
+#else
+    report["optimized"] = false;
+#endif
+    report["compiler"] = __VERSION__;
+    report["timestamp"] = std::time(nullptr);
+    report["results"] = json::array();
+    for (const auto& result : results) {
+        json item;
+        item["name"] = result.name;
+        item["n"] = result.n;
+        item["iterations"] = result.iterations;
+        item["ns_per_op"] = result.ns_per_op;
+        item["allocs_per_op"] = result.allocs_per_op;
+        item["bytes_written_per_op"] = result.bytes_written_per_op;
+        item["rss_bytes_per_op"] = result.rss_bytes_per_op;
+        report["results"].push_back(item);
+    }
+
+    if (out_path.empty()) {
+        std::cout << report.dump(2) << std::endl;
+    } else {
+        std::ofstream out(out_path);
+        out << report.dump(2) << std::endl;
+        if (!out) {
+            std::cerr << "No se pudo escribir " << out_path << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,422 @@
+// Generador de carga HTTP para la API de wake_server.
+//
+//   wake_loadgen [--rate 200] [--duration 10] [--concurrency 64]
+//                [--mix status=60,list=10,list_etag=15,list_filtered=5,create=5,toggle=5]
+//                [--alarms 500] [--burst-every 2] [--burst-size 20]
+//                [--seed 1] [--dir RUTA] [--json FICHERO]
+//
+// Levanta el servidor (las mismas rutas que main) en 127.0.0.1 con un
+// puerto libre y datos en un directorio temporal, y lanza las peticiones
+// en lazo abierto: cada una tiene su instante planificado y la latencia se
+// mide desde ese instante, así que la cola que se forma cuando el servidor
+// no da abasto cuenta (no hay omisión coordinada). El plan sale de --seed:
+// dos ejecuciones con los mismos parámetros envían lo mismo.
+#include "httplib.h"
+#include "core/AlarmManager.h"
+#include "core/AudioBackend.h"
+#include "server/ApiRoutes.h"
+#include "utils/Logger.h"
+#include "utils/Metrics.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+using json = nlohmann::json;
+using SteadyClock = std::chrono::steady_clock;
+
+enum Op { STATUS, LIST, LIST_ETAG, LIST_FILTERED, CREATE, TOGGLE, OP_COUNT };
+
+const char* const OP_NAMES[OP_COUNT] = {
+    "status", "list", "list_etag", "list_filtered", "create", "toggle"
+};
+
+const char* const OP_ROUTES[OP_COUNT] = {
+    "GET /api/alarms/status", "GET /api/alarms", "GET /api/alarms (If-None-Match)",
+    "GET /api/alarms?enabled=true&limit=50", "POST /api/alarms", "PUT /api/alarms/:id/toggle"
+};
+
+struct Slot {
+    int64_t at_ns;   // desde el inicio de la prueba
+    Op op;
+    uint32_t arg;    // índice de alarma para toggle
+};
+
+struct Config {
+    double rate = 200;
+    double duration = 10;
+    size_t concurrency = 64;
+    unsigned weights[OP_COUNT] = {60, 10, 15, 5, 5, 5};
+    size_t alarms = 500;
+    double burst_every = 2;
+    size_t burst_size = 20;
+    uint64_t seed = 1;
+    std::string dir;
+    std::string json_path;
+};
+
+// Lo que registra cada hilo cliente (se junta al final)
+struct WorkerStats {
+    std::vector<int64_t> latencies[OP_COUNT];
+    uint64_t errors[OP_COUNT] = {};
+    uint64_t late = 0;  // empezadas >1 ms tarde: el generador no da abasto
+};
+
+bool parseMix(const std::string& text, unsigned weights[OP_COUNT]) {
+    std::fill(weights, weights + OP_COUNT, 0u);
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find(',', start);
+        if (end == std::string::npos) end = text.size();
+        std::string item = text.substr(start, end - start);
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+
+        std::string name = item.substr(0, eq);
+        auto it = std::find_if(OP_NAMES, OP_NAMES + OP_COUNT,
+                               [&name](const char* op) { return name == op; });
+        if (it == OP_NAMES + OP_COUNT) return false;
+        weights[it - OP_NAMES] = static_cast<unsigned>(std::strtoul(item.c_str() + eq + 1, nullptr, 10));
+        start = end + 1;
+    }
+    return std::any_of(weights, weights + OP_COUNT, [](unsigned w) { return w > 0; });
+}
+
+// Plan determinista: llegadas uniformes a `rate` más ráfagas de
+// creates/toggles cada `burst_every` segundos
+std::vector<Slot> buildSchedule(const Config& config) {
+    std::mt19937_64 rng(config.seed);
+    unsigned total_weight = 0;
+    for (unsigned weight : config.weights) total_weight += weight;
+
+    auto pickAlarm = [&rng, &config] {
+        return static_cast<uint32_t>(rng() % std::max<size_t>(config.alarms, 1));
+    };
+
+    std::vector<Slot> schedule;
+    size_t requests = static_cast<size_t>(config.rate * config.duration);
+    double interval_ns = 1e9 / config.rate;
+    for (size_t i = 0; i < requests; i++) {
+        unsigned pick = static_cast<unsigned>(rng() % total_weight);
+        int op = 0;
+        while (pick >= config.weights[op]) {
+            pick -= config.weights[op];
+            op++;
+        }
+        schedule.push_back({static_cast<int64_t>(i * interval_ns), static_cast<Op>(op), pickAlarm()});
+    }
+
+    if (config.burst_every > 0 && config.burst_size > 0) {
+        for (double t = config.burst_every; t < config.duration; t += config.burst_every) {
+            for (size_t i = 0; i < config.burst_size; i++) {
+                schedule.push_back({static_cast<int64_t>(t * 1e9), (i % 2 == 0) ? CREATE : TOGGLE,
+                                    pickAlarm()});
+            }
+        }
+    }
+
+    std::stable_sort(schedule.begin(), schedule.end(),
+                     [](const Slot& a, const Slot& b) { return a.at_ns < b.at_ns; });
+    return schedule;
+}
+
+bool sendRequest(httplib::Client& client, const Slot& slot, const std::vector<std::string>& ids,
+                 const std::string& etag, int hour) {
+    httplib::Result result;
+    switch (slot.op) {
+        case STATUS:
+            result = client.Get("/api/alarms/status");
+            break;
+        case LIST:
+            result = client.Get("/api/alarms");
+            break;
+        case LIST_ETAG:
+            result = client.Get("/api/alarms", httplib::Headers{{"If-None-Match", etag}});
+            break;
+        case LIST_FILTERED:
+            result = client.Get("/api/alarms?enabled=true&limit=50");
+            break;
+        case CREATE: {
+            json body;
+            body["hour"] = hour;
+            body["minute"] = static_cast<int>(slot.arg % 60);
+            body["label"] = "carga";
+            body["vibrate"] = false;
+            result = client.Post("/api/alarms", body.dump(), "application/json");
+            break;
+        }
+        case TOGGLE:
+            result = client.Put("/api/alarms/" + ids[slot.arg % ids.size()] + "/toggle");
+            break;
+        case OP_COUNT:
+            return false;
+    }
+    if (!result) return false;
+    return (result->status >= 200 && result->status < 300) || result->status == 304;
+}
+
+double percentileMs(const std::vector<int64_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+    size_t index = std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0);
+    return static_cast<double>(sorted[index]) / 1e6;
+}
+
+struct LockSnapshot {
+    uint64_t contended = 0;
+    uint64_t acquisitions = 0;
+    double wait_seconds = 0;
+    double hold_seconds = 0;
+};
+
+LockSnapshot readLockMetrics() {
+    const std::string labels = "mutex=\"alarms\"";
+    LockSnapshot snapshot;
+    snapshot.contended = Metrics::counter("wake_mutex_contended_total", "", labels).value();
+    Histogram& wait = Metrics::histogram("wake_mutex_wait_seconds", "", labels);
+    snapshot.acquisitions = wait.count();
+    snapshot.wait_seconds = wait.sum();
+    snapshot.hold_seconds = Metrics::histogram("wake_mutex_hold_seconds", "", labels).sum();
+    return snapshot;
+}
+
+void usage() {
+    std::cerr << "Uso: wake_loadgen [--rate N] [--duration S] [--concurrency N] [--mix op=peso,...]\n"
+                 "                    [--alarms N] [--burst-every S] [--burst-size N] [--seed N]\n"
+                 "                    [--dir RUTA] [--json FICHERO]\n"
+                 "Operaciones: status list list_etag list_filtered create toggle\n";
+}
+
+bool parseArgs(int argc, char** argv, Config& config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) return false;
+        std::string value = argv[++i];
+        if (arg == "--rate") {
+            config.rate = std::strtod(value.c_str(), nullptr);
+        } else if (arg == "--duration") {
+            config.duration = std::strtod(value.c_str(), nullptr);
+        } else if (arg == "--concurrency") {
+            config.concurrency = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (arg == "--mix") {
+            if (!parseMix(value, config.weights)) return false;
+        } else if (arg == "--alarms") {
+            config.alarms = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (arg == "--burst-every") {
+            config.burst_every = std::strtod(value.c_str(), nullptr);
+        } else if (arg == "--burst-size") {
+            config.burst_size = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (arg == "--seed") {
+            config.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--dir") {
+            config.dir = value;
+        } else if (arg == "--json") {
+            config.json_path = value;
+        } else {
+            return false;
+        }
+    }
+    return config.rate > 0 && config.duration > 0 && config.concurrency > 0;
+}
+
+}
+
+int main(int argc, char** argv) {
+    Config config;
+    if (!parseArgs(argc, argv, config)) {
+        usage();
+        return 2;
+    }
+
+    bool temporary_dir = config.dir.empty();
+    if (temporary_dir) {
+        char pattern[] = "/tmp/wake_loadgen.XXXXXX";
+        if (::mkdtemp(pattern) == nullptr) {
+            std::perror("mkdtemp");
+            return 1;
+        }
+        config.dir = pattern;
+    }
+    const std::string base = config.dir + "/alarms";
+
+    Logger::setConsole(false);
+    Logger::setLevel(Logger::Level::Warning);
+
+    // Las alarmas de prueba quedan 12 h lejos de ahora: no suenan durante la carga
+    std::time_t now = std::time(nullptr);
+    std::tm local{};
+    ::localtime_r(&now, &local);
+    const int hour = (local.tm_hour + 12) % 24;
+
+    AlarmManager::Options options;
+    options.storage_path = base;
+    options.audio_backend = std::make_shared<NullAudioBackend>();
+    AlarmManager manager(options);
+
+    std::vector<std::string> ids;
+    ids.reserve(config.alarms);
+    for (size_t i = 0; i < config.alarms; i++) {
+        ids.push_back(manager.createAlarm(hour, static_cast<int>(i % 60),
+                                          "Alarma " + std::to_string(i), false, "default"));
+    }
+    if (ids.empty()) {
+        // toggle necesita al menos una
+        ids.push_back(manager.createAlarm(hour, 0, "Alarma", false, "default"));
+    }
+    manager.start();
+
+    httplib::Server server;
+    registerRoutes(server, manager);
+    int port = server.bind_to_any_port("127.0.0.1");
+    if (port <= 0) {
+        std::cerr << "No se pudo abrir un puerto en 127.0.0.1\n";
+        return 1;
+    }
+    std::thread server_thread([&server] { server.listen_after_bind(); });
+    server.wait_until_ready();
+
+    std::string etag;
+    {
+        httplib::Client client("127.0.0.1", port);
+        auto result = client.Get("/api/alarms");
+        if (result) etag = result->get_header_value("ETag");
+    }
+
+    std::vector<Slot> schedule = buildSchedule(config);
+    std::fprintf(stderr, "wake_loadgen: %zu peticiones en %.1f s contra 127.0.0.1:%d (%zu clientes)\n",
+                 schedule.size(), config.duration, port, config.concurrency);
+
+    std::vector<WorkerStats> stats(config.concurrency);
+    std::atomic<size_t> next_slot{0};
+    LockSnapshot locks_before = readLockMetrics();
+    const auto started = SteadyClock::now() + std::chrono::milliseconds(100);
+
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < config.concurrency; w++) {
+        workers.emplace_back([&, w] {
+            WorkerStats& mine = stats[w];
+            httplib::Client client("127.0.0.1", port);
+            client.set_keep_alive(true);
+            client.set_connection_timeout(5);
+            client.set_read_timeout(30);
+
+            for (;;) {
+                size_t index = next_slot.fetch_add(1, std::memory_order_relaxed);
+                if (index >= schedule.size()) break;
+                const Slot& slot = schedule[index];
+
+                auto planned = started + std::chrono::nanoseconds(slot.at_ns);
+                if (SteadyClock::now() > planned + std::chrono::milliseconds(1)) mine.late++;
+                std::this_thread::sleep_until(planned);
+
+                bool ok = sendRequest(client, slot, ids, etag, hour);
+                mine.latencies[slot.op].push_back(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(SteadyClock::now() - planned).count());
+                if (!ok) mine.errors[slot.op]++;
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    double elapsed = std::chrono::duration<double>(SteadyClock::now() - started).count();
+    LockSnapshot locks_after = readLockMetrics();
+
+    server.stop();
+    server_thread.join();
+    manager.stop();
+    for (const char* ext : {".snap", ".snap.tmp", ".journal", ".journal.old"}) {
+        ::unlink((base + ext).c_str());
+    }
+    if (temporary_dir) ::rmdir(config.dir.c_str());
+
+    // Informe
+    json report;
+    report["seed"] = config.seed;
+    report["rate"] = config.rate;
+    report["duration_s"] = elapsed;
+    report["concurrency"] = config.concurrency;
+    report["routes"] = json::array();
+
+    uint64_t total = 0;
+    uint64_t total_errors = 0;
+    uint64_t late = 0;
+    for (const auto& worker : stats) late += worker.late;
+
+    std::printf("%-40s %8s %9s %7s %9s %9s %9s %9s\n",
+                "ruta", "n", "req/s", "errores", "p50 ms", "p99 ms", "p999 ms", "max ms");
+    for (int op = 0; op < OP_COUNT; op++) {
+        std::vector<int64_t> latencies;
+        uint64_t errors = 0;
+        for (const auto& worker : stats) {
+            latencies.insert(latencies.end(), worker.latencies[op].begin(), worker.latencies[op].end());
+            errors += worker.errors[op];
+        }
+        if (latencies.empty()) continue;
+        std::sort(latencies.begin(), latencies.end());
+        total += latencies.size();
+        total_errors += errors;
+
+        json route;
+        route["op"] = OP_NAMES[op];
+        route["route"] = OP_ROUTES[op];
+        route["count"] = latencies.size();
+        route["throughput"] = static_cast<double>(latencies.size()) / elapsed;
+        route["errors"] = errors;
+        route["p50_ms"] = percentileMs(latencies, 0.50);
+        route["p99_ms"] = percentileMs(latencies, 0.99);
+        route["p999_ms"] = percentileMs(latencies, 0.999);
+        route["max_ms"] = static_cast<double>(latencies.back()) / 1e6;
+        report["routes"].push_back(route);
+
+        std::printf("%-40s %8zu %9.1f %7llu %9.3f %9.3f %9.3f %9.3f\n",
+                    OP_ROUTES[op], latencies.size(), route["throughput"].get<double>(),
+                    static_cast<unsigned long long>(errors), route["p50_ms"].get<double>(),
+                    route["p99_ms"].get<double>(), route["p999_ms"].get<double>(),
+                    route["max_ms"].get<double>());
+    }
+
+    json lock;
+    lock["acquisitions"] = locks_after.acquisitions - locks_before.acquisitions;
+    lock["contended"] = locks_after.contended - locks_before.contended;
+    lock["wait_seconds"] = locks_after.wait_seconds - locks_before.wait_seconds;
+    lock["hold_seconds"] = locks_after.hold_seconds - locks_before.hold_seconds;
+    report["alarms_mutex"] = lock;
+    report["total"] = total;
+    report["errors"] = total_errors;
+    report["late_starts"] = late;
+
+    std::printf("\ntotal %llu peticiones, %.1f req/s, %llu errores\n",
+                static_cast<unsigned long long>(total), static_cast<double>(total) / elapsed,
+                static_cast<unsigned long long>(total_errors));
+    std::printf("alarms_mutex: %llu bloqueos, %llu con contención, espera %.3f ms, retenido %.3f ms\n",
+                static_cast<unsigned long long>(lock["acquisitions"].get<uint64_t>()),
+                static_cast<unsigned long long>(lock["contended"].get<uint64_t>()),
+                lock["wait_seconds"].get<double>() * 1000, lock["hold_seconds"].get<double>() * 1000);
+    if (late > 0) {
+        std::printf("⚠️  %llu peticiones salieron >1 ms tarde: faltan clientes (--concurrency)\n",
+                    static_cast<unsigned long long>(late));
+    }
+
+    if (!config.json_path.empty()) {
+        std::ofstream out(config.json_path);
+        out << report.dump(2) << std::endl;
+        if (!out) {
+            std::cerr << "No se pudo escribir " << config.json_path << "\n";
+            return 1;
+        }
+    }
+    return total_errors == 0 ? 0 : 1;
+}
@@ -1,4 +1,13 @@
 # Script para embeber múltiples recursos como strings en C++
+#
+# Por cada archivo se genera, en tiempo de compilación:
+#   - el contenido original (raw string)
+#   - una variante precomprimida con gzip (si CMake >= 3.18)
+#   - un hash SHA-256 del contenido, usado como ETag y como versión
+#     (?v=...) en las referencias de los HTML para poder cachear los
+#     recursos de forma indefinida
+# y una tabla constexpr ordenada por ruta: sin inicialización dinámica
+# al arrancar y con búsqueda sin reservas de memoria (o en compilación)
 
 # DEBUG: Imprimir lo que recibimos
 message(STATUS "=== EMBED RESOURCES DEBUG ===")
@@ -28,21 +37,35 @@ message(STATUS "Total archivos válidos: ${FILE_COUNT}")
 if(FILE_COUNT EQUAL 0)
     message(WARNING "⚠️  No se encontraron archivos válidos")
     # Crear header vacío
-    file(WRITE "${OUTPUT_FILE}" 
+    file(WRITE "${OUTPUT_FILE}"
 "#ifndef EMBEDDED_RESOURCES_H
 #define EMBEDDED_RESOURCES_H
-#include <string>
-#include <unordered_map>
+#include <cstddef>
+#include <string_view>
 namespace Resources {
-    struct Resource { const char* content; const char* mime_type; };
-    const std::unordered_map<std::string, Resource> RESOURCE_MAP = {};
-    inline const Resource* getResource(const std::string&) { return nullptr; }
+    struct Resource {
+        std::string_view path; std::string_view content; std::string_view gzip_content;
+        std::string_view mime_type; std::string_view etag; std::string_view gzip_etag; std::string_view version;
+    };
+    inline constexpr Resource RESOURCES[1] = {};  // sin entradas: usar RESOURCE_COUNT
+    inline constexpr size_t RESOURCE_COUNT = 0;
+    constexpr const Resource* getResource(std::string_view) { return nullptr; }
+    constexpr bool hasResource(std::string_view) { return false; }
 }
 #endif
 ")
     return()
 endif()
 
+# Directorio de trabajo para los HTML reescritos y los .gz
+get_filename_component(OUTPUT_DIR "${OUTPUT_FILE}" DIRECTORY)
+set(WORK_DIR "${OUTPUT_DIR}/embedded")
+file(MAKE_DIRECTORY "${WORK_DIR}")
+
+if(CMAKE_VERSION VERSION_LESS 3.18)
+    message(WARNING "⚠️  CMake < 3.18: los recursos se embeben sin variante gzip")
+endif()
+
 # Función para convertir path a variable válida en C++
 function(path_to_varname filepath outvar)
     string(REPLACE "${SOURCE_DIR}/" "" rel_path "${filepath}")
@@ -53,6 +76,18 @@ function(path_to_varname filepath outvar)
     set(${outvar} "${var_name}" PARENT_SCOPE)
 endfunction()
 
+# Función para obtener la ruta web (/css/alarm.css)
+function(path_to_webpath filepath outvar)
+    string(REPLACE "${SOURCE_DIR}/src/view/" "" web_path "${filepath}")
+    string(REPLACE "${SOURCE_DIR}/src/view" "" web_path "${web_path}")
+
+    # Normalizar la ruta web
+    if(NOT web_path MATCHES "^/")
+        set(web_path "/${web_path}")
+    endif()
+    set(${outvar} "${web_path}" PARENT_SCOPE)
+endfunction()
+
 # Función para obtener tipo MIME
 function(get_mime_type filepath outvar)
     if(filepath MATCHES "\\.html$")
@@ -68,91 +103,212 @@ function(get_mime_type filepath outvar)
     endif()
 endfunction()
 
+# Función para comprimir un archivo y devolverlo como inicializador de
+# array C ('\x1f','\x8b',...) junto con su tamaño en bytes
+function(gzip_to_array filepath varname outarray outsize)
+    if(CMAKE_VERSION VERSION_LESS 3.18)
+        set(${outarray} "" PARENT_SCOPE)
+        set(${outsize} 0 PARENT_SCOPE)
+        return()
+    endif()
+
+    set(gz_file "${WORK_DIR}/${varname}.gz")
+    if(CMAKE_VERSION VERSION_LESS 3.19)
+        file(ARCHIVE_CREATE OUTPUT "${gz_file}" PATHS "${filepath}"
+             FORMAT raw COMPRESSION GZip)
+    else()
+        file(ARCHIVE_CREATE OUTPUT "${gz_file}" PATHS "${filepath}"
+             FORMAT raw COMPRESSION GZip COMPRESSION_LEVEL 9)
+    endif()
+
+    file(READ "${gz_file}" hex HEX)
+    string(LENGTH "${hex}" hex_length)
+    math(EXPR size "${hex_length} / 2")
+
+    # 16 bytes por línea
+    string(REGEX REPLACE "([0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f])" "\\1\n    " hex "${hex}")
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "'\\\\x\\1'," array "${hex}")
+
+    set(${outarray} "${array}" PARENT_SCOPE)
+    set(${outsize} ${size} PARENT_SCOPE)
+endfunction()
+
+# Ordenar por ruta web: la tabla generada se busca por bisección
+set(SORT_KEYS "")
+foreach(RESOURCE_FILE ${VALID_FILES})
+    path_to_webpath("${RESOURCE_FILE}" WEB_PATH)
+    list(APPEND SORT_KEYS "${WEB_PATH}|${RESOURCE_FILE}")
+endforeach()
+list(SORT SORT_KEYS)
+set(VALID_FILES "")
+foreach(SORT_KEY ${SORT_KEYS})
+    string(REGEX REPLACE "^[^|]*\\|" "" RESOURCE_FILE "${SORT_KEY}")
+    list(APPEND VALID_FILES "${RESOURCE_FILE}")
+endforeach()
+
+# Primera pasada: hash de los recursos que no son HTML, para poder
+# versionar sus referencias dentro de los HTML
+set(HTML_FILES "")
+set(ASSET_FILES "")
+foreach(RESOURCE_FILE ${VALID_FILES})
+    if(RESOURCE_FILE MATCHES "\\.html$")
+        list(APPEND HTML_FILES "${RESOURCE_FILE}")
+    else()
+        list(APPEND ASSET_FILES "${RESOURCE_FILE}")
+    endif()
+endforeach()
+
+foreach(RESOURCE_FILE ${ASSET_FILES})
+    path_to_varname("${RESOURCE_FILE}" VAR_NAME)
+    file(SHA256 "${RESOURCE_FILE}" FILE_HASH)
+    string(SUBSTRING "${FILE_HASH}" 0 16 FILE_HASH)
+    set(HASH_${VAR_NAME} "${FILE_HASH}")
+    set(INPUT_${VAR_NAME} "${RESOURCE_FILE}")
+endforeach()
+
+# Los HTML se reescriben: "/css/alarm.css" -> "/css/alarm.css?v=<hash>"
+foreach(RESOURCE_FILE ${HTML_FILES})
+    path_to_varname("${RESOURCE_FILE}" VAR_NAME)
+    file(READ "${RESOURCE_FILE}" HTML_CONTENT)
+
+    foreach(ASSET_FILE ${ASSET_FILES})
+        path_to_varname("${ASSET_FILE}" ASSET_VAR)
+        path_to_webpath("${ASSET_FILE}" ASSET_PATH)
+        string(REPLACE "\"${ASSET_PATH}\"" "\"${ASSET_PATH}?v=${HASH_${ASSET_VAR}}\""
+               HTML_CONTENT "${HTML_CONTENT}")
+    endforeach()
+
+    set(REWRITTEN "${WORK_DIR}/${VAR_NAME}")
+    file(WRITE "${REWRITTEN}" "${HTML_CONTENT}")
+    file(SHA256 "${REWRITTEN}" FILE_HASH)
+    string(SUBSTRING "${FILE_HASH}" 0 16 FILE_HASH)
+    set(HASH_${VAR_NAME} "${FILE_HASH}")
+    set(INPUT_${VAR_NAME} "${REWRITTEN}")
+endforeach()
+
 # Iniciar archivo header
-file(WRITE "${OUTPUT_FILE}" 
+file(WRITE "${OUTPUT_FILE}"
 "// AUTO-GENERADO POR CMAKE - NO EDITAR MANUALMENTE
 #ifndef EMBEDDED_RESOURCES_H
 #define EMBEDDED_RESOURCES_H
 
-#include <string>
-#include <unordered_map>
+#include <cstddef>
+#include <string_view>
 
 namespace Resources {
 
 // Estructura para almacenar recursos
 struct Resource {
-    const char* content;
-    const char* mime_type;
+    std::string_view path;
+    std::string_view content;
+    std::string_view gzip_content;  // vacío si no hay variante gzip
+    std::string_view mime_type;
+    std::string_view etag;          // ETag de la variante sin comprimir
+    std::string_view gzip_etag;     // ETag de la variante gzip
+    std::string_view version;       // valor de ?v= en las referencias versionadas
 };
 
 ")
 
 # Procesar cada archivo
 foreach(RESOURCE_FILE ${VALID_FILES})
-    # Leer contenido
-    file(READ "${RESOURCE_FILE}" FILE_CONTENT)
-    
     # Obtener nombre de variable y ruta relativa
     path_to_varname("${RESOURCE_FILE}" VAR_NAME)
     string(REPLACE "${SOURCE_DIR}/" "" REL_PATH "${RESOURCE_FILE}")
-    
-    # Obtener tipo MIME
-    get_mime_type("${RESOURCE_FILE}" MIME_TYPE)
-    
-    message(STATUS "  → ${REL_PATH} -> ${VAR_NAME}")
-    
+
+    # Leer contenido (ya reescrito en el caso de los HTML)
+    set(INPUT_FILE "${INPUT_${VAR_NAME}}")
+    file(READ "${INPUT_FILE}" FILE_CONTENT)
+    file(SIZE "${INPUT_FILE}" FILE_SIZE)
+    gzip_to_array("${INPUT_FILE}" "${VAR_NAME}" GZIP_ARRAY GZIP_SIZE)
+    set(GZIP_SIZE_${VAR_NAME} ${GZIP_SIZE})
+
+    message(STATUS "  → ${REL_PATH} -> ${VAR_NAME} (${FILE_SIZE} B, gzip ${GZIP_SIZE} B)")
+
     # Escribir constante con raw string
-    file(APPEND "${OUTPUT_FILE}" 
+    file(APPEND "${OUTPUT_FILE}"
 "// ${REL_PATH}
-const char* ${VAR_NAME} = R\"EMBED_RESOURCE(${FILE_CONTENT})EMBED_RESOURCE\";
-
+inline constexpr char ${VAR_NAME}[] = R\"EMBED_RESOURCE(${FILE_CONTENT})EMBED_RESOURCE\";
 ")
+    if(GZIP_SIZE GREATER 0)
+        file(APPEND "${OUTPUT_FILE}"
+"inline constexpr char ${VAR_NAME}_GZ[] = {
+    ${GZIP_ARRAY}
+};
+")
+    endif()
+    file(APPEND "${OUTPUT_FILE}" "\n")
 endforeach()
 
 # Crear mapa de recursos
-file(APPEND "${OUTPUT_FILE}" 
-"// Mapa de recursos: ruta -> {contenido, mime_type}
-const std::unordered_map<std::string, Resource> RESOURCE_MAP = {
+file(APPEND "${OUTPUT_FILE}"
+"// Tabla de recursos ordenada por ruta
+inline constexpr Resource RESOURCES[] = {
 ")
 
 set(FIRST_ENTRY TRUE)
 foreach(RESOURCE_FILE ${VALID_FILES})
     path_to_varname("${RESOURCE_FILE}" VAR_NAME)
-    string(REPLACE "${SOURCE_DIR}/src/view/" "" WEB_PATH "${RESOURCE_FILE}")
-    string(REPLACE "${SOURCE_DIR}/src/view" "" WEB_PATH "${WEB_PATH}")
-    
-    # Normalizar la ruta web
-    if(NOT WEB_PATH MATCHES "^/")
-        set(WEB_PATH "/${WEB_PATH}")
-    endif()
-    
+    path_to_webpath("${RESOURCE_FILE}" WEB_PATH)
     get_mime_type("${RESOURCE_FILE}" MIME_TYPE)
-    
+    set(FILE_HASH "${HASH_${VAR_NAME}}")
+
+    if(GZIP_SIZE_${VAR_NAME} GREATER 0)
+        set(GZIP_REF "{${VAR_NAME}_GZ, sizeof(${VAR_NAME}_GZ)}")
+    else()
+        set(GZIP_REF "{}")
+    endif()
+
     if(NOT FIRST_ENTRY)
         file(APPEND "${OUTPUT_FILE}" ",\n")
     endif()
     set(FIRST_ENTRY FALSE)
-    
-    message(STATUS "  📍 Ruta web: ${WEB_PATH} -> ${VAR_NAME}")
-    file(APPEND "${OUTPUT_FILE}" "    {\"${WEB_PATH}\", {${VAR_NAME}, \"${MIME_TYPE}\"}}")
+
+    message(STATUS "  📍 Ruta web: ${WEB_PATH} -> ${VAR_NAME} (${FILE_HASH})")
+    file(APPEND "${OUTPUT_FILE}" "    {\"${WEB_PATH}\", {${VAR_NAME}, sizeof(${VAR_NAME}) - 1}, ${GZIP_REF},
+     \"${MIME_TYPE}\", \"\\\"${FILE_HASH}\\\"\", \"\\\"${FILE_HASH}-gz\\\"\", \"${FILE_HASH}\"}")
 endforeach()
 
-file(APPEND "${OUTPUT_FILE}" 
+file(APPEND "${OUTPUT_FILE}"
 "
 };
 
-// Función helper para obtener recursos
-inline const Resource* getResource(const std::string& path) {
-    auto it = RESOURCE_MAP.find(path);
-    if (it != RESOURCE_MAP.end()) {
-        return &it->second;
+inline constexpr size_t RESOURCE_COUNT = sizeof(RESOURCES) / sizeof(RESOURCES[0]);
+
+// Búsqueda por bisección; constexpr para poder resolver en compilación
+// las rutas fijas
+constexpr const Resource* getResource(std::string_view path) {
+    size_t low = 0;
+    size_t high = RESOURCE_COUNT;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (RESOURCES[mid].path < path) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low < RESOURCE_COUNT && RESOURCES[low].path == path) {
+        return &RESOURCES[low];
     }
     return nullptr;
 }
 
+constexpr bool hasResource(std::string_view path) {
+    return getResource(path) != nullptr;
+}
+
+constexpr bool isSorted() {
+    for (size_t i = 1; i < RESOURCE_COUNT; i++) {
+        if (!(RESOURCES[i - 1].path < RESOURCES[i].path)) return false;
+    }
+    return true;
+}
+static_assert(isSorted(), \"RESOURCES debe estar ordenada por ruta\");
+
 } // namespace Resources
 
 #endif // EMBEDDED_RESOURCES_H
 ")
 
-message(STATUS "✅ resources.h generado con ${FILE_COUNT} recursos")
\ No newline at end of file
+message(STATUS "✅ resources.h generado con ${FILE_COUNT} recursos")
@@ -1,217 +1,844 @@
 #include "AlarmManager.h"
-#include "../utils/TimeUtils.h"
 #include "../utils/Logger.h"
-#include "../models/AlarmStorage.cpp"
-#include <chrono>
+#include "../utils/Hash.h"
 #include <algorithm>
-#include <sstream>
-#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+AlarmManager::AlarmManager()
+    : AlarmManager(Options()) {
+}
 
-AlarmManager::AlarmManager() 
-    : audio_player_(std::make_unique<AudioPlayer>()) {
-    loadAlarms();
+AlarmManager::AlarmManager(Options options)
+    : storage_path_(options.storage_path),
+      namespaces_dir_(options.storage_path + ".ns"),
+      clock_(options.clock ? std::move(options.clock) : Clock::system()),
+      on_fired_(std::move(options.on_fired)),
+      audio_player_(options.audio_backend
+                        ? std::make_unique<AudioPlayer>(std::move(options.audio_backend), clock_)
+                        : std::make_unique<AudioPlayer>(clock_)),
+      wakelock_(options.wakelock, clock_) {
+    default_shard_ = getShard(std::string());
+    discoverNamespaces();
+    lists_thread_ = std::thread(&AlarmManager::publishListsLoop, this);
 }
 
 AlarmManager::~AlarmManager() {
     stop();
+    {
+        std::lock_guard<std::mutex> lock(lists_mutex_);
+        lists_running_ = false;
+    }
+    lists_cv_.notify_all();
+    lists_thread_.join();
 }
 
 void AlarmManager::start() {
     running_ = true;
+    {
+        std::shared_lock<std::shared_mutex> lock(shards_mutex_);
+        for (auto& entry : shards_) {
+            entry.second->start();
+        }
+    }
+    wakelock_.start();
     check_thread_ = std::thread(&AlarmManager::checkAlarmsLoop, this);
     Logger::info("AlarmManager iniciado");
 }
 
 void AlarmManager::stop() {
-    running_ = false;
+    {
+        // Bajo el mutex para que el hilo no se pierda el aviso entre
+        // comprobar running_ y ponerse a esperar
+        std::lock_guard<InstrumentedMutex> lock(schedule_mutex_);
+        running_ = false;
+    }
+    scheduler_cv_.notify_all();
     if (check_thread_.joinable()) {
         check_thread_.join();
     }
+
+    // Detener un shard vacía su journal (fsync): fuera de shards_mutex_,
+    // que también toman las peticiones en curso
+    std::vector<std::pair<std::string, std::shared_ptr<AlarmShard>>> shards;
+    {
+        std::shared_lock<std::shared_mutex> lock(shards_mutex_);
+        shards.assign(shards_.begin(), shards_.end());
+    }
+    for (auto& entry : shards) {
+        entry.second->stop();
+        // Al volver a arrancar, los namespaces se cargan cuando les toque
+        if (!entry.first.empty()) {
+            std::time_t due;
+            writeDueFile(entry.first, entry.second->nextDue(due) ? due : -1);
+        }
+    }
+    wakelock_.stop();
+    events_.close();
     Logger::info("AlarmManager detenido");
 }
 
-std::string AlarmManager::createAlarm(int hour, int minute, const std::string& label,
-                                     bool vibrate, const std::string& sound_file) {
-    std::lock_guard<std::mutex> lock(alarms_mutex_);
-    
-    Alarm alarm;
-    alarm.id = TimeUtils::generateUUID();
-    alarm.hour = hour;
-    alarm.minute = minute;
-    alarm.label = label;
-    alarm.enabled = true;
-    alarm.vibrate = vibrate;
-    alarm.sound_file = sound_file;
-    
-    alarms_.push_back(alarm);
-    saveAlarms();
-    
-    Logger::info("Alarma creada: " + alarm.id + " para " + 
-                 std::to_string(hour) + ":" + std::to_string(minute));
-    
-    return alarm.id;
-}
-
-bool AlarmManager::deleteAlarm(const std::string& id) {
-    std::lock_guard<std::mutex> lock(alarms_mutex_);
-    
-    auto it = std::find_if(alarms_.begin(), alarms_.end(),
-                          [&id](const Alarm& a) { return a.id == id; });
-    
-    if (it != alarms_.end()) {
-        alarms_.erase(it);
-        saveAlarms();
-        Logger::info("Alarma eliminada: " + id);
-        return true;
+bool AlarmManager::isValidNamespace(const std::string& ns) {
+    if (ns.empty() || ns.size() > 64) return false;
+    return std::all_of(ns.begin(), ns.end(), [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+               (c >= '0' && c <= '9') || c == '_' || c == '-';
+    });
+}
+
+std::string AlarmManager::createAlarm(const std::string& ns, int hour, int minute,
+                                      const std::string& label, bool vibrate,
+                                      const std::string& sound_file, const Recurrence& repeat) {
+    AlarmOperation op;
+    op.type = AlarmOperation::Type::Create;
+    op.hour = hour;
+    op.minute = minute;
+    op.label = label;
+    op.vibrate = vibrate;
+    op.sound_file = sound_file;
+    op.repeat = repeat;
+
+    AlarmOperationResult result = getShard(ns)->applyBatch({op}, clock_->time()).front();
+    if (!result.success) {
+        throw std::invalid_argument(result.error);
     }
-    
-    return false;
+
+    Logger::info("Alarma creada: " + result.id + " para " +
+                 std::to_string(hour) + ":" + std::to_string(minute) +
+                 (ns.empty() ? "" : " en " + ns));
+
+    return result.id;
 }
 
-bool AlarmManager::toggleAlarm(const std::string& id) {
-    std::lock_guard<std::mutex> lock(alarms_mutex_);
-    
-    auto it = std::find_if(alarms_.begin(), alarms_.end(),
-                          [&id](const Alarm& a) { return a.id == id; });
-    
-    if (it != alarms_.end()) {
-        it->enabled = !it->enabled;
-        saveAlarms();
-        Logger::info("Alarma " + id + " " + (it->enabled ? "activada" : "desactivada"));
-        return true;
+bool AlarmManager::deleteAlarm(const std::string& ns, const std::string& id) {
+    AlarmOperation op;
+    op.type = AlarmOperation::Type::Delete;
+    op.id = id;
+
+    auto shard = getShard(ns, false);
+    if (!shard || !shard->applyBatch({op}, clock_->time()).front().success) return false;
+
+    // Si estaba sonando o pospuesta, su sesión termina con ella
+    stopAlarm(ns, id);
+    Logger::info("Alarma eliminada: " + id);
+    return true;
+}
+
+bool AlarmManager::toggleAlarm(const std::string& ns, const std::string& id) {
+    AlarmOperation op;
+    op.type = AlarmOperation::Type::Toggle;
+    op.id = id;
+
+    auto shard = getShard(ns, false);
+    if (!shard || !shard->applyBatch({op}, clock_->time()).front().success) return false;
+
+    Logger::info("Alarma " + id + " cambiada de estado");
+    return true;
+}
+
+bool AlarmManager::updateAlarm(const std::string& ns, const std::string& id,
+                               const AlarmOperation& changes) {
+    AlarmOperation op = changes;
+    op.type = AlarmOperation::Type::Update;
+    op.id = id;
+
+    auto shard = getShard(ns, false);
+    if (!shard || !shard->applyBatch({op}, clock_->time()).front().success) return false;
+
+    Logger::info("Alarma actualizada: " + id);
+    return true;
+}
+
+std::vector<AlarmOperationResult> AlarmManager::applyBatch(const std::string& ns,
+                                                           const std::vector<AlarmOperation>& ops) {
+    // Sólo un lote con altas crea el namespace
+    bool creates = std::any_of(ops.begin(), ops.end(), [](const AlarmOperation& op) {
+        return op.type == AlarmOperation::Type::Create;
+    });
+    auto shard = getShard(ns, creates);
+
+    std::vector<AlarmOperationResult> results;
+    if (shard) {
+        results = shard->applyBatch(ops, clock_->time());
+    } else {
+        for (const auto& op : ops) {
+            AlarmOperationResult result;
+            result.id = op.id;
+            result.error = "Alarma no encontrada";
+            results.push_back(std::move(result));
+        }
     }
-    
-    return false;
+
+    size_t applied = 0;
+    for (size_t i = 0; i < ops.size(); i++) {
+        if (!results[i].success) continue;
+        applied++;
+        if (ops[i].type == AlarmOperation::Type::Delete) {
+            stopAlarm(ns, ops[i].id);
+        }
+    }
+
+    Logger::info("Lote aplicado: " + std::to_string(applied) + "/" +
+                 std::to_string(ops.size()) + " operaciones");
+    return results;
+}
+
+nlohmann::json AlarmManager::getAllAlarms(const std::string& ns) {
+    auto shard = getShard(ns, false);
+    return shard ? shard->getAllAlarms() : nlohmann::json::array();
+}
+
+std::shared_ptr<const AlarmListSnapshot> AlarmManager::getAlarmListSnapshot(const std::string& ns) {
+    auto shard = getShard(ns, false);
+    if (shard) return shard->getAlarmListSnapshot();
+
+    // Namespace sin datos: lista vacía, sin crear el shard
+    static const std::shared_ptr<const AlarmListSnapshot> empty = [] {
+        auto snapshot = std::make_shared<AlarmListSnapshot>();
+        snapshot->version = 0;
+        snapshot->json = "[]";
+        char etag[19];
+        std::snprintf(etag, sizeof(etag), "\"%016llx\"",
+                      static_cast<unsigned long long>(fnv1a64(snapshot->json.data(), snapshot->json.size())));
+        snapshot->etag = etag;
+        return snapshot;
+    }();
+    return empty;
+}
+
+bool AlarmManager::readAlarmPage(const std::string& ns, const AlarmQuery& query, std::string& cursor,
+                                 size_t max_records, std::string& out, size_t& emitted) {
+    auto shard = getShard(ns, false);
+    return shard && shard->readAlarmPage(query, cursor, max_records, out, emitted);
+}
+
+bool AlarmManager::stopAlarm(const std::string& ns, const std::string& id) {
+    AlarmId alarm_id = AlarmId::fromString(id);
+    {
+        std::lock_guard<InstrumentedMutex> lock(sessions_mutex_);
+        const RingSessions::Session* session = sessions_.find(ns, alarm_id);
+        if (!session) return false;
+
+        InternedString label = session->label;
+        sessions_.stop(ns, alarm_id);
+        refreshRingingLocked();
+        events_.publish("alarm-stopped", ringEventLocked(ns, alarm_id, label));
+    }
+
+    invalidateShardList(ns);
+    syncAudio();
+    Logger::info("Alarma detenida por el usuario: " + id);
+    return true;
 }
 
-nlohmann::json AlarmManager::getAllAlarms() {
-    std::lock_guard<std::mutex> lock(alarms_mutex_);
-    
-    nlohmann::json result = nlohmann::json::array();
-    for (const auto& alarm : alarms_) {
-        nlohmann::json j;
-        j["id"] = alarm.id;
-        j["hour"] = alarm.hour;
-        j["minute"] = alarm.minute;
-        j["label"] = alarm.label;
-        j["enabled"] = alarm.enabled;
-        j["vibrate"] = alarm.vibrate;
-        j["sound_file"] = alarm.sound_file;
-        j["ringing"] = (current_ringing_alarm_ == alarm.id);
-        result.push_back(j);
+bool AlarmManager::snoozeAlarm(const std::string& ns, const std::string& id, int minutes) {
+    AlarmId alarm_id = AlarmId::fromString(id);
+    {
+        std::lock_guard<InstrumentedMutex> lock(sessions_mutex_);
+        std::time_t now = clock_->time();
+        if (!sessions_.snooze(ns, alarm_id, now, static_cast<std::time_t>(minutes) * 60)) return false;
+
+        refreshRingingLocked();
+        const RingSessions::Session* session = sessions_.find(ns, alarm_id);
+        events_.publish("alarm-snoozed", ringEventLocked(ns, alarm_id, session->label));
+    }
+    {
+        // El scheduler tiene que despertarse al final del snooze
+        std::lock_guard<InstrumentedMutex> lock(schedule_mutex_);
+        schedule_generation_++;
     }
-    
-    return result;
+    scheduler_cv_.notify_one();
+
+    invalidateShardList(ns);
+    syncAudio();
+    Logger::info("😴 Alarma " + id + " pospuesta " + std::to_string(minutes) + " min");
+    return true;
+}
+
+void AlarmManager::stopAlarms(const std::string& ns) {
+    {
+        std::lock_guard<InstrumentedMutex> lock(sessions_mutex_);
+        std::vector<RingSessions::Session> stopped = sessions_.stopNamespace(ns);
+        if (stopped.empty()) return;
+
+        refreshRingingLocked();
+        for (const auto& session : stopped) {
+            events_.publish("alarm-stopped", ringEventLocked(ns, session.alarm_id, session.label));
+        }
+    }
+
+    invalidateShardList(ns);
+    syncAudio();
+    Logger::info("Alarmas detenidas por el usuario" + (ns.empty() ? "" : " en " + ns));
 }
 
 void AlarmManager::stopCurrentAlarm() {
-    if (alarm_ringing_) {
-        audio_player_->stop();
-        alarm_ringing_ = false;
-        current_ringing_alarm_.clear();
-        Logger::info("Alarma detenida por el usuario");
+    std::vector<std::string> namespaces;
+    {
+        std::lock_guard<InstrumentedMutex> lock(sessions_mutex_);
+        if (sessions_.empty()) return;
+
+        std::vector<RingSessions::Session> stopped = sessions_.stopAll();
+        refreshRingingLocked();
+        for (const auto& session : stopped) {
+            events_.publish("alarm-stopped", ringEventLocked(session.ns, session.alarm_id, session.label));
+            if (std::find(namespaces.begin(), namespaces.end(), session.ns) == namespaces.end()) {
+                namespaces.push_back(session.ns);
+            }
+        }
     }
+
+    for (const auto& ns : namespaces) {
+        invalidateShardList(ns);
+    }
+    syncAudio();
+    Logger::info("Alarmas detenidas por el usuario");
+}
+
+bool AlarmManager::flush() {
+    std::vector<std::shared_ptr<AlarmShard>> shards;
+    {
+        // Los que se están descargando escriben lo suyo al detenerse
+        std::unique_lock<std::shared_mutex> lock(shards_mutex_);
+        shards_cv_.wait(lock, [this] { return evicting_.empty(); });
+        for (const auto& entry : shards_) shards.push_back(entry.second);
+    }
+    bool ok = true;
+    for (const auto& shard : shards) {
+        ok = shard->flush() && ok;
+    }
+    return ok;
+}
+
+AudioPlayer::LatencyStats AlarmManager::getAudioLatency() const {
+    return audio_player_->latencyStats();
+}
+
+WakeLockManager::Stats AlarmManager::getWakeLockStats() const {
+    return wakelock_.stats();
+}
+
+AlarmStorage::Stats AlarmManager::getStorageStats() {
+    return default_shard_->getStorageStats();
+}
+
+size_t AlarmManager::getAlarmCount() {
+    return default_shard_->getAlarmCount();
+}
+
+size_t AlarmManager::getLoadedNamespaceCount() {
+    std::shared_lock<std::shared_mutex> lock(shards_mutex_);
+    return shards_.size();
 }
 
 bool AlarmManager::isAlarmRinging() const {
     return alarm_ringing_;
 }
 
-std::string AlarmManager::getCurrentRingingAlarmLabel() {
-    std::lock_guard<std::mutex> lock(alarms_mutex_);
-    
-    if (!alarm_ringing_ || current_ringing_alarm_.empty()) {
-        return "";
+AlarmManager::RingStatus AlarmManager::getRingStatus() {
+    std::lock_guard<InstrumentedMutex> lock(sessions_mutex_);
+
+    RingStatus status;
+    if (const RingSessions::Session* current = sessions_.current()) {
+        status.ringing = true;
+        status.ns = current->ns;
+        status.id = current->alarm_id.toString();
+        status.label = current->label;
+    }
+    status.sessions = sessions_.sessions();
+    return status;
+}
+
+std::shared_ptr<AlarmShard> AlarmManager::getShard(const std::string& ns, bool create) {
+    if (!ns.empty() && !isValidNamespace(ns)) {
+        throw std::invalid_argument("Namespace inválido: " + ns);
+    }
+
+    // Lo normal: ya está cargado. Uno que se está descargando ya no está
+    // en el mapa, así que no hace falta mirar evicting_
+    std::shared_ptr<AlarmShard> shard = findLoadedShard(ns);
+    if (!shard) {
+        shard = insertShard(ns, create);
+        if (!shard) return nullptr;
+    }
+
+    // Fuera del mapa: leer el disco sólo frena a quien usa este namespace
+    shard->load();
+    if (running_) shard->start();
+    return shard;
+}
+
+std::shared_ptr<AlarmShard> AlarmManager::insertShard(const std::string& ns, bool create) {
+    auto loaded = [this, &ns](std::unique_lock<std::shared_mutex>& lock) {
+        // Recién descargado: hasta que termine de escribir, el disco no
+        // tiene todos sus datos
+        shards_cv_.wait(lock, [this, &ns] { return evicting_.count(ns) == 0; });
+        auto it = shards_.find(ns);
+        return it == shards_.end() ? nullptr : it->second;
+    };
+
+    {
+        std::unique_lock<std::shared_mutex> lock(shards_mutex_);
+        if (auto shard = loaded(lock)) return shard;
+    }
+
+    // Los accesos al disco y la construcción, sin shards_mutex_: un
+    // namespace nuevo no frena las peticiones de los demás
+    if (!create && !ns.empty() && !shardExistsOnDisk(ns)) return nullptr;
+    if (!ns.empty()) {
+        ::mkdir(namespaces_dir_.c_str(), 0755);  // EEXIST es lo normal
+    }
+
+    AlarmShard::Hooks hooks;
+    hooks.ringing_ids = [this](const std::string& shard_ns) {
+        return ringingIds(shard_ns);
+    };
+    hooks.due_changed = [this](const std::string& shard_ns, std::time_t due) {
+        setShardDue(shard_ns, due);
+    };
+    hooks.list_stale = [this](const std::string& shard_ns) {
+        markListStale(shard_ns);
+    };
+    // Aún sin cargar: hace de marcador en el mapa hasta que load() lea el disco
+    auto fresh = std::make_shared<AlarmShard>(ns, shardPath(ns), clock_, std::move(hooks));
+
+    std::unique_lock<std::shared_mutex> lock(shards_mutex_);
+    // Otro hilo pudo insertarlo mientras tanto: se usa el suyo
+    if (auto shard = loaded(lock)) return shard;
+    shards_.emplace(ns, fresh);
+    return fresh;
+}
+
+std::shared_ptr<AlarmShard> AlarmManager::findLoadedShard(const std::string& ns) {
+    std::shared_lock<std::shared_mutex> lock(shards_mutex_);
+    auto it = shards_.find(ns);
+    return it == shards_.end() ? nullptr : it->second;
+}
+
+std::string AlarmManager::shardPath(const std::string& ns) const {
+    return ns.empty() ? storage_path_ : namespaces_dir_ + "/" + ns;
+}
+
+bool AlarmManager::shardExistsOnDisk(const std::string& ns) const {
+    const std::string base = shardPath(ns);
+    for (const char* ext : {".snap", ".journal", ".journal.old", ".json"}) {
+        if (::access((base + ext).c_str(), F_OK) == 0) return true;
     }
-    
-    auto it = std::find_if(alarms_.begin(), alarms_.end(),
-                          [this](const Alarm& a) { return a.id == current_ringing_alarm_; });
-    
-    if (it != alarms_.end()) {
-        return it->label;
+    return false;
+}
+
+// Al arrancar sólo se lee el .due de cada namespace; los que no lo tienen
+// o lo tienen más viejo que sus datos (p.ej. tras un corte de luz) se
+// cargan para recalcularlo
+void AlarmManager::discoverNamespaces() {
+    DIR* dir = ::opendir(namespaces_dir_.c_str());
+    if (!dir) return;
+
+    std::set<std::string> namespaces;
+    while (struct dirent* entry = ::readdir(dir)) {
+        std::string name = entry->d_name;
+        size_t dot = name.find('.');
+        if (dot == std::string::npos) continue;
+
+        std::string ext = name.substr(dot);
+        std::string ns = name.substr(0, dot);
+        if ((ext == ".snap" || ext == ".journal" || ext == ".journal.old" || ext == ".json") &&
+            isValidNamespace(ns)) {
+            namespaces.insert(ns);
+        }
+    }
+    ::closedir(dir);
+
+    auto mtime = [](const std::string& path, struct timespec& out) {
+        struct stat st;
+        if (::stat(path.c_str(), &st) != 0) return false;
+        out = st.st_mtim;
+        return true;
+    };
+    auto newer = [](const struct timespec& a, const struct timespec& b) {
+        return a.tv_sec != b.tv_sec ? a.tv_sec > b.tv_sec : a.tv_nsec > b.tv_nsec;
+    };
+
+    size_t deferred = 0;
+    for (const auto& ns : namespaces) {
+        const std::string base = shardPath(ns);
+        struct timespec due_time{}, data_time{};
+        bool fresh = mtime(base + ".due", due_time);
+        for (const char* ext : {".snap", ".journal", ".journal.old", ".json"}) {
+            if (fresh && mtime(base + ext, data_time) && newer(data_time, due_time)) {
+                fresh = false;
+            }
+        }
+
+        std::time_t due = -1;
+        std::ifstream file(base + ".due");
+        if (fresh && (file >> due)) {
+            if (due >= 0) setShardDue(ns, due);
+            deferred++;
+        } else {
+            getShard(ns);
+        }
     }
-    
-    return "Alarma";
+
+    Logger::info("Namespaces: " + std::to_string(namespaces.size()) + " (" +
+                 std::to_string(deferred) + " sin cargar)");
 }
 
-// 🔧 FIX: Verificar cada 5 segundos y agregar logs de depuración
+void AlarmManager::evictIdleShards(std::time_t now) {
+    struct Evicted {
+        std::string ns;
+        std::shared_ptr<AlarmShard> shard;
+        std::time_t due;
+    };
+    std::vector<Evicted> evicted;
+    {
+        std::lock_guard<std::shared_mutex> lock(shards_mutex_);
+        for (auto it = shards_.begin(); it != shards_.end();) {
+            const std::shared_ptr<AlarmShard>& shard = it->second;
+
+            // Sólo se crean referencias nuevas con shards_mutex_ tomado
+            // (aunque sea compartido): si nadie más la tiene ahora, nadie
+            // la va a tener
+            bool idle = !it->first.empty() && shard.use_count() == 1 &&
+                        now - shard->lastUsed() >= SHARD_IDLE_SECONDS;
+            std::time_t due = -1;
+            if (idle) {
+                std::lock_guard<InstrumentedMutex> sessions_lock(sessions_mutex_);
+                idle = !sessions_.hasNamespace(it->first);
+            }
+            if (idle && shard->nextDue(due) && due - now <= AUDIO_ARM_LEAD_SECONDS) {
+                idle = false;  // a punto de sonar
+            }
+            if (!idle) {
+                ++it;
+                continue;
+            }
+
+            evicting_.insert(it->first);
+            evicted.push_back({it->first, shard, due});
+            it = shards_.erase(it);
+        }
+    }
+    if (evicted.empty()) return;
+
+    // Vaciar la cola de escritura (fsync) sin shards_mutex_: sólo espera
+    // quien pida uno de estos namespaces, para que la recarga lea todo
+    for (const auto& entry : evicted) {
+        entry.shard->stop();
+        writeDueFile(entry.ns, entry.due);
+    }
+    {
+        std::lock_guard<std::shared_mutex> lock(shards_mutex_);
+        for (const auto& entry : evicted) evicting_.erase(entry.ns);
+    }
+    shards_cv_.notify_all();
+
+    Logger::info("Descargados " + std::to_string(evicted.size()) + " namespaces sin uso");
+}
+
+void AlarmManager::writeDueFile(const std::string& ns, std::time_t due) {
+    const std::string path = shardPath(ns) + ".due";
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::trunc);
+        file << due << '\n';
+        if (!file) {
+            Logger::error("No se pudo escribir " + tmp);
+            return;
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        Logger::error("No se pudo renombrar " + tmp);
+    }
+}
+
+void AlarmManager::setShardDue(const std::string& ns, std::time_t due) {
+    {
+        std::lock_guard<InstrumentedMutex> lock(schedule_mutex_);
+        auto it = shard_due_.find(ns);
+        if (it != shard_due_.end()) {
+            if (it->second == due) return;
+            due_order_.erase({it->second, ns});
+            shard_due_.erase(it);
+        }
+        if (due >= 0) {
+            shard_due_.emplace(ns, due);
+            due_order_.emplace(due, ns);
+        }
+        schedule_generation_++;
+    }
+    scheduler_cv_.notify_one();
+}
+
+AlarmShard::RingingIds AlarmManager::ringingIds(const std::string& ns) {
+    std::lock_guard<InstrumentedMutex> lock(sessions_mutex_);
+    AlarmShard::RingingIds ids;
+    for (const auto& session : sessions_.sessions()) {
+        if (session.ns == ns && session.state == RingSessions::State::Ringing) {
+            ids.insert(session.alarm_id);
+        }
+    }
+    return ids;
+}
+
+void AlarmManager::markListStale(const std::string& ns) {
+    bool first;
+    {
+        std::lock_guard<std::mutex> lock(lists_mutex_);
+        first = stale_lists_.empty();
+        stale_lists_.insert(ns);
+    }
+    // Con alguna ya pendiente el hilo ya tiene el aviso
+    if (first) lists_cv_.notify_one();
+}
+
+void AlarmManager::publishListChanged(const std::string& ns, uint64_t version) {
+    // El namespace sólo lleva [A-Za-z0-9_-]: no hace falta escaparlo
+    events_.publish("list-changed", ns.empty()
+        ? "{\"version\":" + std::to_string(version) + "}"
+        : "{\"ns\":\"" + ns + "\",\"version\":" + std::to_string(version) + "}");
+}
+
+void AlarmManager::invalidateShardList(const std::string& ns) {
+    if (auto shard = findLoadedShard(ns)) {
+        shard->invalidateAlarmList();
+    }
+}
+
+// Duerme hasta el primer disparo de cualquier namespace, el próximo plazo
+// de una sesión o hasta que algo cambie (schedule_generation_), en lugar
+// de sondear. Sólo bloquea el shard al que le toca disparar.
 void AlarmManager::checkAlarmsLoop() {
-    int last_minute = -1;
-    
-    while (running_) {
-        auto now = TimeUtils::getCurrentTime();
-        
-        // 🔍 LOG DE DEPURACIÓN: Mostrar hora actual cada minuto
-        if (now.minute != last_minute) {
-            std::ostringstream oss;
-            oss << "⏰ Hora actual del servidor: " 
-                << std::setfill('0') << std::setw(2) << now.hour << ":"
-                << std::setfill('0') << std::setw(2) << now.minute;
-            Logger::info(oss.str());
-            last_minute = now.minute;
-        }
-        
+    while (true) {
+        uint64_t seen;
+        std::string due_ns;
+        std::time_t due = -1;
         {
-            std::lock_guard<std::mutex> lock(alarms_mutex_);
-            
-            for (auto& alarm : alarms_) {
-                if (!alarm.enabled) continue;
-                
-                // 🔍 LOG: Verificar cada alarma activa
-                if (now.minute != last_minute && alarms_.size() > 0) {
-                    std::ostringstream debug;
-                    debug << "  📌 Alarma " << alarm.id << ": "
-                          << std::setfill('0') << std::setw(2) << alarm.hour << ":"
-                          << std::setfill('0') << std::setw(2) << alarm.minute
-                          << " (enabled=" << alarm.enabled 
-                          << ", triggered_today=" << alarm.triggered_today << ")";
-                    Logger::info(debug.str());
-                }
-                
-                if (now.hour == alarm.hour && now.minute == alarm.minute && 
-                    !alarm.triggered_today) {
-                    
-                    triggerAlarm(alarm);
-                    alarm.triggered_today = true;
-                }
-                
-                // Reset diario a medianoche
-                if (now.hour == 0 && now.minute == 0 && alarm.triggered_today) {
-                    alarm.triggered_today = false;
-                    Logger::info("Reset diario para alarma: " + alarm.id);
+            std::lock_guard<InstrumentedMutex> lock(schedule_mutex_);
+            if (!running_) break;
+            seen = schedule_generation_;
+            if (!due_order_.empty()) {
+                due = due_order_.begin()->first;
+                due_ns = due_order_.begin()->second;
+            }
+        }
+        std::time_t now = clock_->time();
+
+        // Auto-stop y fin de snooze de las alarmas que suenan: mismo hilo,
+        // así que no hace falta un hilo por alarma disparada
+        if (expireSessions(now)) {
+            // stop() del audio espera al hilo de audio: fuera de los mutex
+            syncAudio();
+            continue;
+        }
+
+        // El wake lock se toma poco antes de esta hora y se suelta después
+        wakelock_.setNextDue(due);
+
+        if (due >= 0 && due <= now) {
+            fireShard(due_ns, now);
+            syncAudio();
+            continue;
+        }
+
+        std::time_t wake_at = -1;
+        if (due >= 0) {
+            // Poco antes del disparo se deja el audio preparado (y el
+            // namespace cargado), para que al sonar solo quede arrancar la
+            // reproducción
+            std::time_t arm_at = due - AUDIO_ARM_LEAD_SECONDS;
+            if (now >= arm_at) {
+                std::string sound_file;
+                std::time_t shard_due;
+                auto shard = getShard(due_ns, false);
+                if (shard && shard->nextDue(shard_due, &sound_file)) {
+                    audio_player_->arm(sound_file);
                 }
+                arm_at = due;
+            }
+            wake_at = arm_at;
+        }
+
+        {
+            std::lock_guard<InstrumentedMutex> lock(sessions_mutex_);
+            std::time_t session_deadline;
+            if (sessions_.nextDeadline(session_deadline)) {
+                wake_at = wake_at < 0 ? session_deadline : std::min(wake_at, session_deadline);
             }
         }
-        
-        // 🔧 FIX: Verificar cada 5 segundos en lugar de 15
-        std::this_thread::sleep_for(std::chrono::seconds(5));
+
+        if (getLoadedNamespaceCount() > 1) {
+            if (now >= next_eviction_) {
+                evictIdleShards(now);
+                next_eviction_ = now + SHARD_EVICT_INTERVAL_SECONDS;
+            }
+            wake_at = wake_at < 0 ? next_eviction_ : std::min(wake_at, next_eviction_);
+        }
+
+        std::unique_lock<InstrumentedMutex> lock(schedule_mutex_);
+        auto changed = [this, seen] { return !running_ || schedule_generation_ != seen; };
+        if (wake_at < 0) {
+            scheduler_cv_.wait(lock, changed);
+        } else {
+            // Un reloj simulado puede saltar directamente hasta wake_at
+            auto deadline = std::chrono::system_clock::from_time_t(wake_at);
+            if (!changed()) clock_->idleUntil(deadline);
+            scheduler_cv_.wait_until(lock, clock_->realTime(deadline), changed);
+        }
     }
 }
 
-void AlarmManager::triggerAlarm(const Alarm& alarm) {
-    Logger::info("🔔 ALARMA ACTIVADA EN SERVIDOR: " + alarm.label);
-    
-    alarm_ringing_ = true;
-    current_ringing_alarm_ = alarm.id;
-    
-    // Reproducir sonido EN EL SERVIDOR (Termux)
-    audio_player_->play(alarm.sound_file, alarm.vibrate);
-    
-    // Auto-detener después de 5 minutos
-    std::thread([this]() {
-        std::this_thread::sleep_for(std::chrono::minutes(5));
-        if (alarm_ringing_) {
-            Logger::warning("Alarma auto-detenida después de 5 minutos");
-            stopCurrentAlarm();
+// Regenera las listas que quedaron viejas. Construir una toma el mutex de
+// su shard durante todo el recorrido, así que tras cada tanda se espera
+// LIST_PUBLISH_INTERVAL (o lo que duró, si fue más): un cambio suelto se
+// publica enseguida y una ráfaga se junta en pocas regeneraciones, sin
+// dejar a las escrituras y a los disparos esperando por el mutex.
+void AlarmManager::publishListsLoop() {
+    std::unique_lock<std::mutex> lock(lists_mutex_);
+    while (true) {
+        lists_cv_.wait(lock, [this] { return !lists_running_ || !stale_lists_.empty(); });
+        if (!lists_running_) break;
+
+        std::set<std::string> stale;
+        stale.swap(stale_lists_);
+        lock.unlock();
+
+        auto started = std::chrono::steady_clock::now();
+        for (const auto& ns : stale) {
+            // Uno descargado publica la suya al volver a cargarse
+            auto shard = findLoadedShard(ns);
+            uint64_t version = shard ? shard->publishAlarmList() : 0;
+            if (version > 0) publishListChanged(ns, version);
         }
-    }).detach();
+        auto busy = std::chrono::steady_clock::now() - started;
+
+        lock.lock();
+        lists_cv_.wait_for(lock, std::max<std::chrono::steady_clock::duration>(busy, LIST_PUBLISH_INTERVAL),
+                           [this] { return !lists_running_; });
+    }
 }
 
-void AlarmManager::saveAlarms() {
-    AlarmStorage::save(alarms_);
+// El sonido lo arranca syncAudio() después, sin mutex
+void AlarmManager::fireShard(const std::string& ns, std::time_t now) {
+    // Retraso entre el minuto programado y el disparo real
+    static Histogram& drift = Metrics::histogram(
+        "wake_alarm_fire_drift_seconds",
+        "Retraso del disparo respecto al minuto programado", "",
+        {0.01, 0.05, 0.1, 0.25, 0.5, 1, 2, 5, 10, 30, 60, 300});
+
+    auto shard = getShard(ns, false);
+    if (!shard) {
+        // Borraron sus ficheros por fuera
+        setShardDue(ns, -1);
+        return;
+    }
+
+    std::vector<AlarmShard::Fired> fired = shard->popDue(now);
+    if (fired.empty()) return;
+
+    {
+        std::lock_guard<InstrumentedMutex> lock(sessions_mutex_);
+        for (const auto& entry : fired) {
+            double late = std::chrono::duration<double>(
+                clock_->now() - std::chrono::system_clock::from_time_t(entry.due)).count();
+            drift.observe(late);
+            if (on_fired_) on_fired_(ns, entry.alarm, late);
+            Logger::info("🔔 ALARMA ACTIVADA EN SERVIDOR: " + entry.alarm.label.get());
+
+            sessions_.start(ns, entry.alarm, now);
+            refreshRingingLocked();
+            events_.publish("alarm-fired", ringEventLocked(ns, entry.alarm.id, entry.alarm.label));
+        }
+    }
+    shard->invalidateAlarmList();
 }
 
-void AlarmManager::loadAlarms() {
-    alarms_ = AlarmStorage::load();
-    Logger::info("Cargadas " + std::to_string(alarms_.size()) + " alarmas");
-}
\ No newline at end of file
+bool AlarmManager::expireSessions(std::time_t now) {
+    std::vector<std::string> namespaces;
+    {
+        std::lock_guard<InstrumentedMutex> lock(sessions_mutex_);
+        std::vector<RingSessions::Expired> expired = sessions_.popExpired(now);
+        if (expired.empty()) return false;
+
+        refreshRingingLocked();
+        for (const auto& entry : expired) {
+            const RingSessions::Session& session = entry.session;
+            if (entry.stopped) {
+                Logger::warning("Alarma auto-detenida después de " +
+                                std::to_string(RING_TIMEOUT_SECONDS / 60) + " minutos: " + session.label.get());
+                events_.publish("alarm-stopped", ringEventLocked(session.ns, session.alarm_id, session.label));
+            } else {
+                Logger::info("🔔 Fin del snooze: " + session.label.get());
+                events_.publish("alarm-fired", ringEventLocked(session.ns, session.alarm_id, session.label));
+            }
+            if (std::find(namespaces.begin(), namespaces.end(), session.ns) == namespaces.end()) {
+                namespaces.push_back(session.ns);
+            }
+        }
+    }
+
+    for (const auto& ns : namespaces) {
+        invalidateShardList(ns);
+    }
+    return true;
+}
+
+void AlarmManager::refreshRingingLocked() {
+    alarm_ringing_ = sessions_.ringingCount() > 0;
+    // Pospuesta también cuenta: el móvil tiene que seguir despierto para
+    // volver a sonar
+    wakelock_.setRinging(!sessions_.empty());
+}
+
+// Evento de una sesión (ns/id/label) junto con el estado global tras el
+// cambio, para que la UI sepa si aún suena otra
+std::string AlarmManager::ringEventLocked(const std::string& ns, AlarmId id,
+                                          const std::string& label) const {
+    nlohmann::json event;
+    event["id"] = id.toString();
+    event["label"] = label;
+    if (!ns.empty()) event["ns"] = ns;
+
+    const RingSessions::Session* current = sessions_.current();
+    event["ringing"] = (current != nullptr);
+    event["current"] = current ? current->alarm_id.toString() : "";
+    event["current_label"] = current ? current->label.get() : "";
+    if (current && !current->ns.empty()) event["current_ns"] = current->ns;
+    return event.dump();
+}
+
+// Lleva el audio al estado de las sesiones. Se llama sin mutex después de
+// cada cambio; como todas pasan por audio_mutex_, la última llamada ve el
+// estado final aunque varios hilos cambien sesiones a la vez.
+void AlarmManager::syncAudio() {
+    std::lock_guard<std::mutex> audio_lock(audio_mutex_);
+
+    bool ringing = false;
+    std::string sound_file;
+    bool vibrate = false;
+    uint64_t generation = 0;
+    {
+        std::lock_guard<InstrumentedMutex> lock(sessions_mutex_);
+        if (const RingSessions::Session* current = sessions_.current()) {
+            ringing = true;
+            sound_file = current->sound_file;
+            vibrate = current->vibrate;
+        }
+        generation = sessions_.ringGeneration();
+    }
+
+    if (ringing) {
+        // Otra alarma (o el fin de un snooze) reinicia la reproducción
+        if (generation != audio_generation_ || !audio_player_->isPlaying()) {
+            audio_player_->play(sound_file, vibrate);
+            audio_generation_ = generation;
+        }
+    } else if (audio_player_->isPlaying()) {
+        audio_player_->stop();
+    }
+}
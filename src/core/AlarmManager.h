@@ -3,46 +3,262 @@
 
 #include <vector>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <map>
+#include <set>
+#include <utility>
 #include <thread>
+#include <chrono>
 #include <atomic>
 #include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <functional>
+#include <ctime>
 #include <nlohmann/json.hpp>
 #include "../models/Alarm.h"
+#include "../models/AlarmStorage.h"
+#include "../models/AlarmOperation.h"
+#include "../models/AlarmQuery.h"
+#include "../utils/InstrumentedMutex.h"
+#include "../utils/Clock.h"
+#include "AlarmShard.h"
+#include "RingSessions.h"
 #include "AudioPlayer.h"
+#include "WakeLockManager.h"
+#include "EventHub.h"
 
+// Alarmas repartidas en namespaces (usuario o dispositivo), cada uno en su
+// AlarmShard con su propio mutex y sus propios ficheros. El namespace ""
+// es el de siempre (/api/alarms, fichero alarms.*) y está siempre cargado;
+// el resto (/api/u/:user/alarms) viven en <storage_path>.ns/<user>.* y se
+// cargan la primera vez que se usan o que les toca sonar. Los que llevan un
+// rato sin usarse se descargan: su primer disparo queda en <user>.due para
+// que el scheduler no tenga que cargarlos hasta entonces.
+//
+// Orden de bloqueo: shards_mutex_ -> mutex de un shard -> sessions_mutex_
+// / schedule_mutex_ / lists_mutex_. Nunca se toma un shard teniendo las sesiones o el
+// schedule, así que el hilo del scheduler sólo bloquea el shard que dispara.
 class AlarmManager {
 public:
+    struct Options {
+        // Ruta base de los datos, sin extensión (ver AlarmStorage)
+        std::string storage_path = "alarms";
+        // nullptr: se detecta el backend de audio disponible
+        std::shared_ptr<AudioBackend> audio_backend;
+        WakeLockManager::Options wakelock = WakeLockManager::Options::fromEnvironment();
+        // nullptr: el reloj del sistema
+        std::shared_ptr<Clock> clock;
+        // Con cada disparo, desde el hilo del scheduler y con las sesiones
+        // bloqueadas: no debe llamar al manager (p.ej. --simulate).
+        // drift_seconds es el retraso respecto al minuto programado
+        std::function<void(const std::string& ns, const Alarm& alarm, double drift_seconds)> on_fired;
+    };
+    
     AlarmManager();
+    explicit AlarmManager(Options options);
     ~AlarmManager();
     
     void start();
     void stop();
     
-    std::string createAlarm(int hour, int minute, const std::string& label, 
-                           bool vibrate, const std::string& sound_file);
-    bool deleteAlarm(const std::string& id);
-    bool toggleAlarm(const std::string& id);
-    nlohmann::json getAllAlarms();
+    // Nombre de namespace válido: 1..64 caracteres [A-Za-z0-9_-]
+    static bool isValidNamespace(const std::string& ns);
+    
+    // Todas las operaciones llevan el namespace delante; las versiones sin
+    // él usan el namespace por defecto. Un namespace inválido lanza
+    // std::invalid_argument.
+    std::string createAlarm(const std::string& ns, int hour, int minute, const std::string& label,
+                            bool vibrate, const std::string& sound_file,
+                            const Recurrence& repeat = Recurrence());
+    bool deleteAlarm(const std::string& ns, const std::string& id);
+    bool toggleAlarm(const std::string& ns, const std::string& id);
+    bool updateAlarm(const std::string& ns, const std::string& id, const AlarmOperation& changes);
+    
+    std::string createAlarm(int hour, int minute, const std::string& label,
+                           bool vibrate, const std::string& sound_file,
+                           const Recurrence& repeat = Recurrence()) {
+        return createAlarm(std::string(), hour, minute, label, vibrate, sound_file, repeat);
+    }
+    bool deleteAlarm(const std::string& id) { return deleteAlarm(std::string(), id); }
+    bool toggleAlarm(const std::string& id) { return toggleAlarm(std::string(), id); }
+    bool updateAlarm(const std::string& id, const AlarmOperation& changes) {
+        return updateAlarm(std::string(), id, changes);
+    }
+    
+    // Aplica todas las operaciones bajo un único bloqueo y con un único
+    // commit a disco; cada una tiene su propio resultado (las que fallan
+    // no deshacen las demás)
+    std::vector<AlarmOperationResult> applyBatch(const std::string& ns,
+                                                 const std::vector<AlarmOperation>& ops);
+    std::vector<AlarmOperationResult> applyBatch(const std::vector<AlarmOperation>& ops) {
+        return applyBatch(std::string(), ops);
+    }
+    
+    nlohmann::json getAllAlarms(const std::string& ns = std::string());
+    
+    // Lista serializada que publica el hilo de listas: leerla es sólo una
+    // carga atómica de puntero, sin tocar el mutex del shard. Tras un cambio
+    // va por detrás hasta que ese hilo la regenera; list-changed se emite
+    // cuando la nueva ya está publicada
+    std::shared_ptr<const AlarmListSnapshot> getAlarmListSnapshot(const std::string& ns = std::string());
+    
+    // Página de GET /api/alarms con filtros: añade a `out` (como elementos
+    // de un array JSON, escritos directamente desde los Alarm) hasta
+    // `max_records` alarmas posteriores a `cursor`, que avanza. Revisa como
+    // mucho un número acotado de alarmas por llamada para no retener el
+    // mutex. Devuelve false cuando ya no quedan alarmas por recorrer.
+    bool readAlarmPage(const std::string& ns, const AlarmQuery& query, std::string& cursor,
+                       size_t max_records, std::string& out, size_t& emitted);
+    bool readAlarmPage(const AlarmQuery& query, std::string& cursor,
+                       size_t max_records, std::string& out, size_t& emitted) {
+        return readAlarmPage(std::string(), query, cursor, max_records, out, emitted);
+    }
+    
+    // Sesiones de alarma sonando: cada alarma que suena se detiene o se
+    // pospone por separado; a los RING_TIMEOUT_SECONDS se detiene sola
+    static constexpr std::time_t RING_TIMEOUT_SECONDS = 5 * 60;
+    static constexpr int DEFAULT_SNOOZE_MINUTES = 9;
+    
+    // false si esa alarma no está sonando ni pospuesta
+    bool stopAlarm(const std::string& ns, const std::string& id);
+    bool stopAlarm(const std::string& id) { return stopAlarm(std::string(), id); }
+    // false si esa alarma no está sonando
+    bool snoozeAlarm(const std::string& ns, const std::string& id, int minutes);
+    bool snoozeAlarm(const std::string& id, int minutes = DEFAULT_SNOOZE_MINUTES) {
+        return snoozeAlarm(std::string(), id, minutes);
+    }
+    // Detiene las de un namespace (sonando y pospuestas)
+    void stopAlarms(const std::string& ns);
+    // Detiene todas, de cualquier namespace
     void stopCurrentAlarm();
     
-    // Nuevos métodos para que el cliente sepa si hay alarma sonando
+    // Espera a que todos los cambios hechos hasta ahora estén en disco;
+    // false si el journal de algún namespace falló (se sigue reintentando)
+    bool flush();
+    
+    // Para que el cliente sepa si hay alarma sonando
+    struct RingStatus {
+        bool ringing = false;
+        std::string ns;
+        std::string id;     // la que empezó a sonar más recientemente
+        std::string label;
+        std::vector<RingSessions::Session> sessions;
+    };
+    
     bool isAlarmRinging() const;
-    std::string getCurrentRingingAlarmLabel();
-
+    RingStatus getRingStatus();
+    
+    // Latencia entre el disparo y el primer sonido
+    AudioPlayer::LatencyStats getAudioLatency() const;
+    
+    // Tiempo con y sin wake lock
+    WakeLockManager::Stats getWakeLockStats() const;
+    
+    // Registros, commits y bytes escritos a disco (namespace por defecto)
+    AlarmStorage::Stats getStorageStats();
+    
+    // Alarmas del namespace por defecto
+    size_t getAlarmCount();
+    // Namespaces cargados en memoria, contando el de por defecto
+    size_t getLoadedNamespaceCount();
+    
+    // Eventos alarm-fired / alarm-stopped / list-changed para /api/events;
+    // los de otros namespaces llevan "ns"
+    EventHub& events() { return events_; }
+    
 private:
+    // Antelación con la que se prepara el audio de la próxima alarma
+    static constexpr std::time_t AUDIO_ARM_LEAD_SECONDS = 30;
+    // Un namespace sin uso ni alarmas sonando se descarga pasado este tiempo
+    static constexpr std::time_t SHARD_IDLE_SECONDS = 10 * 60;
+    static constexpr std::time_t SHARD_EVICT_INTERVAL_SECONDS = 60;
+    // Separación mínima entre dos tandas del hilo de listas
+    static constexpr std::chrono::milliseconds LIST_PUBLISH_INTERVAL{10};
+    
+    // El shard del namespace, cargándolo si hace falta. Con create = false
+    // devuelve nullptr si el namespace no tiene datos en disco (las
+    // lecturas de un namespace desconocido no crean ficheros).
+    std::shared_ptr<AlarmShard> getShard(const std::string& ns, bool create = true);
+    std::shared_ptr<AlarmShard> findLoadedShard(const std::string& ns);
+    // Mete en el mapa un shard sin cargar (o devuelve el que ya haya)
+    std::shared_ptr<AlarmShard> insertShard(const std::string& ns, bool create);
+    std::string shardPath(const std::string& ns) const;
+    bool shardExistsOnDisk(const std::string& ns) const;
+    void discoverNamespaces();
+    void evictIdleShards(std::time_t now);
+    void writeDueFile(const std::string& ns, std::time_t due);
+    
+    // Hooks de los shards
+    void setShardDue(const std::string& ns, std::time_t due);
+    AlarmShard::RingingIds ringingIds(const std::string& ns);
+    void markListStale(const std::string& ns);
+    void publishListChanged(const std::string& ns, uint64_t version);
+    
     void checkAlarmsLoop();
-    void triggerAlarm(const Alarm& alarm);
-    void saveAlarms();
-    void loadAlarms();
+    void publishListsLoop();
+    void fireShard(const std::string& ns, std::time_t now);
+    bool expireSessions(std::time_t now);
+    void refreshRingingLocked();
+    std::string ringEventLocked(const std::string& ns, AlarmId id,
+                                const std::string& label) const;
+    void invalidateShardList(const std::string& ns);
+    void syncAudio();
+    
+    const std::string storage_path_;
+    const std::string namespaces_dir_;
+    const std::shared_ptr<Clock> clock_;
+    const std::function<void(const std::string&, const Alarm&, double)> on_fired_;
+    
+    // Shards cargados. El mutex sólo protege el mapa: buscar uno lo toma
+    // compartido y el disco (comprobar, crear, cargar) se toca siempre fuera,
+    // así que un namespace nuevo no frena a los demás
+    std::shared_mutex shards_mutex_;
+    std::unordered_map<std::string, std::shared_ptr<AlarmShard>> shards_;
+    // Namespaces ya fuera del mapa cuyo shard se está deteniendo (fuera del
+    // mutex); getShard espera por shards_cv_ a que terminen antes de recargarlos
+    std::set<std::string> evicting_;
+    std::condition_variable_any shards_cv_;
+    std::shared_ptr<AlarmShard> default_shard_;
+    std::time_t next_eviction_ = 0;
     
-    std::vector<Alarm> alarms_;
     std::thread check_thread_;
     std::atomic<bool> running_{false};
-    std::mutex alarms_mutex_;
+    
+    // Namespaces cuya lista publicada quedó vieja. publishListsLoop las
+    // regenera fuera de las peticiones y de los disparos, juntando en una
+    // sola los cambios que llegan mientras tanto. Vive lo que el manager,
+    // no entre start() y stop(), para que la lista nunca se quede atrás
+    std::mutex lists_mutex_;
+    std::condition_variable lists_cv_;
+    std::set<std::string> stale_lists_;
+    bool lists_running_ = true;
+    std::thread lists_thread_;
+    
+    // Primer disparo de cada namespace (cargado o no) ordenado por hora:
+    // checkAlarmsLoop duerme hasta el primero. Cada cambio incrementa
+    // schedule_generation_ y avisa por scheduler_cv_
+    InstrumentedMutex schedule_mutex_{"schedule"};
+    std::condition_variable_any scheduler_cv_;
+    std::unordered_map<std::string, std::time_t> shard_due_;
+    std::set<std::pair<std::time_t, std::string>> due_order_;
+    uint64_t schedule_generation_ = 0;
     
     std::unique_ptr<AudioPlayer> audio_player_;
+    WakeLockManager wakelock_;
+    
+    // Alarmas sonando o pospuestas de todos los namespaces; el hilo del
+    // scheduler también vigila sus plazos (auto-stop y fin del snooze)
+    InstrumentedMutex sessions_mutex_{"sessions"};
+    RingSessions sessions_{RING_TIMEOUT_SECONDS};
     std::atomic<bool> alarm_ringing_{false};
-    std::string current_ringing_alarm_;
+    
+    // Serializa play()/stop() del audio, que se llaman fuera de los mutex
+    std::mutex audio_mutex_;
+    uint64_t audio_generation_ = 0;
+    
+    EventHub events_;
 };
 
-#endif
\ No newline at end of file
+#endif
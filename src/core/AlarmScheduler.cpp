@@ -0,0 +1,94 @@
+#include "AlarmScheduler.h"
+#include <algorithm>
+
+namespace {
+// Comparador para std::push_heap/pop_heap: el menor due queda en la cima
+struct LaterDue {
+    template <typename E>
+    bool operator()(const E& a, const E& b) const { return a.due > b.due; }
+};
+}
+
+void AlarmScheduler::schedule(SlotHandle alarm, std::time_t due) {
+    if (alarm.index >= live_seq_.size()) {
+        live_seq_.resize(alarm.index + 1, 0);
+    }
+    if (live_seq_[alarm.index] == 0) {
+        live_count_++;
+    }
+    
+    uint64_t seq = ++next_seq_;
+    live_seq_[alarm.index] = seq;
+    heap_.push_back(Entry{due, seq, alarm});
+    std::push_heap(heap_.begin(), heap_.end(), LaterDue());
+    compactIfNeeded();
+}
+
+void AlarmScheduler::cancel(SlotHandle alarm) {
+    if (alarm.index >= live_seq_.size() || live_seq_[alarm.index] == 0) return;
+    
+    live_seq_[alarm.index] = 0;
+    live_count_--;
+    compactIfNeeded();
+}
+
+void AlarmScheduler::clear() {
+    heap_.clear();
+    live_seq_.clear();
+    live_count_ = 0;
+}
+
+bool AlarmScheduler::nextDue(std::time_t& due) {
+    dropStaleTop();
+    if (heap_.empty()) return false;
+    due = heap_.front().due;
+    return true;
+}
+
+bool AlarmScheduler::nextDue(std::time_t& due, SlotHandle& alarm) {
+    if (!nextDue(due)) return false;
+    alarm = heap_.front().alarm;
+    return true;
+}
+
+std::vector<AlarmScheduler::DueAlarm> AlarmScheduler::popDue(std::time_t now) {
+    std::vector<DueAlarm> due_alarms;
+    
+    dropStaleTop();
+    while (!heap_.empty() && heap_.front().due <= now) {
+        due_alarms.push_back({heap_.front().alarm, heap_.front().due});
+        live_seq_[heap_.front().alarm.index] = 0;
+        live_count_--;
+        popTop();
+        dropStaleTop();
+    }
+    
+    return due_alarms;
+}
+
+bool AlarmScheduler::isLive(const Entry& entry) const {
+    return entry.alarm.index < live_seq_.size() &&
+           live_seq_[entry.alarm.index] == entry.seq;
+}
+
+void AlarmScheduler::popTop() {
+    std::pop_heap(heap_.begin(), heap_.end(), LaterDue());
+    heap_.pop_back();
+}
+
+void AlarmScheduler::dropStaleTop() {
+    while (!heap_.empty() && !isLive(heap_.front())) {
+        popTop();
+    }
+}
+
+// Reconstruye el heap cuando las entradas obsoletas dominan, para que
+// muchos toggles seguidos no lo hagan crecer sin límite.
+void AlarmScheduler::compactIfNeeded() {
+    if (heap_.size() < 64 || heap_.size() <= 2 * live_count_) return;
+    
+    heap_.erase(std::remove_if(heap_.begin(), heap_.end(),
+                               [this](const Entry& e) { return !isLive(e); }),
+                heap_.end());
+    std::make_heap(heap_.begin(), heap_.end(), LaterDue());
+}
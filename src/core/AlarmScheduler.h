@@ -0,0 +1,52 @@
+#ifndef ALARM_SCHEDULER_H
+#define ALARM_SCHEDULER_H
+
+#include <ctime>
+#include <cstdint>
+#include <vector>
+#include "../utils/SlotMap.h"
+
+// Min-heap de alarmas ordenadas por su próximo disparo.
+// Reprogramar o cancelar no recorre el heap: la entrada anterior queda
+// obsoleta y se descarta al llegar a la cima (borrado perezoso).
+// No es thread-safe: cada AlarmShard la protege con su mutex.
+class AlarmScheduler {
+public:
+    void schedule(SlotHandle alarm, std::time_t due);
+    void cancel(SlotHandle alarm);
+    void clear();
+    
+    // Hora del próximo disparo; false si no hay nada programado
+    bool nextDue(std::time_t& due);
+    // Igual, indicando además qué alarma es
+    bool nextDue(std::time_t& due, SlotHandle& alarm);
+    
+    struct DueAlarm {
+        SlotHandle alarm;
+        std::time_t due;
+    };
+    
+    // Extrae (y desprograma) todas las alarmas con due <= now
+    std::vector<DueAlarm> popDue(std::time_t now);
+    
+    size_t size() const { return live_count_; }
+
+private:
+    struct Entry {
+        std::time_t due;
+        uint64_t seq;
+        SlotHandle alarm;
+    };
+    
+    bool isLive(const Entry& entry) const;
+    void popTop();
+    void dropStaleTop();
+    void compactIfNeeded();
+    
+    std::vector<Entry> heap_;
+    std::vector<uint64_t> live_seq_;  // índice de slot -> seq vigente (0 = nada)
+    size_t live_count_ = 0;
+    uint64_t next_seq_ = 0;
+};
+
+#endif
@@ -0,0 +1,430 @@
+#include "AlarmShard.h"
+#include "../utils/Logger.h"
+#include "../utils/Hash.h"
+#include "../utils/JsonWriter.h"
+#include "../models/AlarmCodec.h"
+#include <algorithm>
+#include <cstdio>
+
+AlarmShard::AlarmShard(std::string name, const std::string& storage_path,
+                       std::shared_ptr<Clock> clock, Hooks hooks)
+    : name_(std::move(name)),
+      clock_(std::move(clock)),
+      hooks_(std::move(hooks)),
+      storage_(storage_path) {
+}
+
+AlarmShard::~AlarmShard() {
+    stop();
+}
+
+void AlarmShard::load() {
+    std::call_once(loaded_, [this] {
+        touch();
+        std::vector<Alarm> loaded = storage_.load();
+
+        std::lock_guard<InstrumentedMutex> lock(mutex_);
+        timing_.reserve(loaded.size());
+        details_.reserve(loaded.size());
+        alarm_index_.reserve(loaded.size());
+
+        std::time_t now = clock_->time();
+        for (auto& alarm : loaded) {
+            if (alarm_index_.count(alarm.id) > 0) {
+                Logger::warning("Alarma duplicada ignorada: " + alarm.id.toString());
+                continue;
+            }
+            // Los ids nuevos no pueden repetir uno que ya está en disco
+            AlarmId::observe(alarm.id);
+
+            SlotHandle handle = insertLocked(std::move(alarm));
+            AlarmTiming& timing = *timing_.get(handle);
+            if (timing.enabled) {
+                scheduleAlarm(handle, timing, details_[handle.index].repeat, now);
+            }
+        }
+        // El manager puede tener un valor viejo (fichero .due): avisar siempre
+        reportDueLocked(true);
+
+        // Los lectores encuentran siempre una lista publicada
+        auto snapshot = std::make_shared<AlarmListSnapshot>();
+        snapshot->version = list_version_.load();
+        appendAlarmListLocked(snapshot->json);
+        storeAlarmList(std::move(snapshot));
+
+        Logger::info("Cargadas " + std::to_string(timing_.size()) + " alarmas (" +
+                     std::to_string(scheduler_.size()) + " programadas)" +
+                     (name_.empty() ? "" : " en " + name_));
+    });
+}
+
+void AlarmShard::start() {
+    // Se llama en cada acceso con el manager en marcha: no tocar el storage
+    if (started_.exchange(true)) return;
+    // Puede llegar desde AlarmManager::start() mientras otro hilo lo carga
+    load();
+    storage_.start([this] {
+        std::lock_guard<InstrumentedMutex> lock(mutex_);
+        return allAlarmsLocked();
+    });
+}
+
+void AlarmShard::stop() {
+    started_ = false;
+    storage_.stop();
+}
+
+std::vector<AlarmOperationResult> AlarmShard::applyBatch(const std::vector<AlarmOperation>& ops,
+                                                         std::time_t now) {
+    touch();
+
+    std::vector<AlarmOperationResult> results;
+    results.reserve(ops.size());
+    size_t applied = 0;
+
+    // Un solo bloqueo: nadie ve el lote a medias
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+
+    AlarmStorage::Batch batch;
+    for (const auto& op : ops) {
+        results.push_back(applyOperationLocked(op, batch, now));
+        if (results.back().success) applied++;
+    }
+
+    // Un único append: todo el lote va en el mismo commit
+    storage_.append(batch);
+    if (applied > 0) {
+        reportDueLocked();
+        invalidateAlarmList();
+    }
+    return results;
+}
+
+AlarmOperationResult AlarmShard::applyOperationLocked(const AlarmOperation& op,
+                                                      AlarmStorage::Batch& batch,
+                                                      std::time_t now) {
+    AlarmOperationResult result;
+    result.id = op.id;
+
+    if ((op.hour && (*op.hour < 0 || *op.hour > 23)) ||
+        (op.minute && (*op.minute < 0 || *op.minute > 59))) {
+        result.error = "Hora inválida";
+        return result;
+    }
+
+    if (op.type == AlarmOperation::Type::Create) {
+        if (!op.hour || !op.minute) {
+            result.error = "hour y minute son obligatorios";
+            return result;
+        }
+
+        Recurrence repeat = op.repeat.value_or(Recurrence());
+        bool enabled = op.enabled.value_or(true);
+        if (enabled && repeat.nextFire(*op.hour, *op.minute, now) < 0) {
+            result.error = "La repetición no tiene más días";
+            return result;
+        }
+
+        Alarm alarm;
+        alarm.id = AlarmId::generate();
+        alarm.hour = static_cast<uint8_t>(*op.hour);
+        alarm.minute = static_cast<uint8_t>(*op.minute);
+        alarm.label = op.label ? std::string_view(*op.label) : std::string_view("Alarma");
+        alarm.enabled = enabled;
+        alarm.vibrate = op.vibrate.value_or(true);
+        alarm.sound_file = op.sound_file ? std::string_view(*op.sound_file) : std::string_view("default");
+        alarm.repeat = repeat;
+
+        SlotHandle handle = insertLocked(alarm);
+        AlarmTiming& timing = *timing_.get(handle);
+        if (timing.enabled) {
+            scheduleAlarm(handle, timing, *alarm.repeat, now);
+            alarm.next_fire = timing.next_fire;
+        }
+        batch.put(alarm);
+
+        result.id = alarm.id.toString();
+        result.success = true;
+        return result;
+    }
+
+    auto it = alarm_index_.find(AlarmId::fromString(op.id));
+    if (it == alarm_index_.end()) {
+        result.error = "Alarma no encontrada";
+        return result;
+    }
+    SlotHandle handle = it->second;
+
+    if (op.type == AlarmOperation::Type::Delete) {
+        scheduler_.cancel(handle);
+        timing_.erase(handle);
+        // Suelta los textos compartidos; el slot se reutilizará
+        details_[handle.index] = AlarmDetails();
+        batch.erase(it->first);
+        id_order_.erase(it->first);
+        alarm_index_.erase(it);
+
+        result.success = true;
+        return result;
+    }
+
+    // Se valida sobre una copia: si la regla resultante ya no tiene días
+    // la alarma queda como estaba
+    Alarm updated = assembleLocked(handle);
+    if (op.type == AlarmOperation::Type::Toggle) {
+        updated.enabled = !updated.enabled;
+    } else {
+        if (op.hour) updated.hour = static_cast<uint8_t>(*op.hour);
+        if (op.minute) updated.minute = static_cast<uint8_t>(*op.minute);
+        if (op.label) updated.label = *op.label;
+        if (op.enabled) updated.enabled = *op.enabled;
+        if (op.vibrate) updated.vibrate = *op.vibrate;
+        if (op.sound_file) updated.sound_file = *op.sound_file;
+        if (op.repeat) updated.repeat = *op.repeat;
+    }
+
+    if (updated.enabled && updated.repeat->nextFire(updated.hour, updated.minute, now) < 0) {
+        result.error = "La repetición no tiene más días";
+        return result;
+    }
+
+    AlarmTiming& timing = *timing_.get(handle);
+    timing = updated;
+    details_[handle.index] = updated;
+    if (timing.enabled) {
+        scheduleAlarm(handle, timing, *updated.repeat, now);
+    } else {
+        timing.next_fire = -1;
+        scheduler_.cancel(handle);
+    }
+    batch.put(updated);
+
+    result.success = true;
+    return result;
+}
+
+nlohmann::json AlarmShard::getAllAlarms() {
+    std::string json;
+    {
+        std::lock_guard<InstrumentedMutex> lock(mutex_);
+        appendAlarmListLocked(json);
+    }
+    return nlohmann::json::parse(json);
+}
+
+std::shared_ptr<const AlarmListSnapshot> AlarmShard::getAlarmListSnapshot() {
+    touch();
+    return std::atomic_load(&list_snapshot_);
+}
+
+uint64_t AlarmShard::publishAlarmList() {
+    // Nunca una lista a medio cargar
+    load();
+
+    auto snapshot = std::make_shared<AlarmListSnapshot>();
+    {
+        std::lock_guard<InstrumentedMutex> lock(mutex_);
+        snapshot->version = list_version_.load();
+        auto published = std::atomic_load(&list_snapshot_);
+        if (published && published->version == snapshot->version) return 0;
+        appendAlarmListLocked(snapshot->json);
+    }
+
+    uint64_t version = snapshot->version;
+    storeAlarmList(std::move(snapshot));
+    return version;
+}
+
+void AlarmShard::storeAlarmList(std::shared_ptr<AlarmListSnapshot> snapshot) {
+    // Desde publishAlarmList() el hash se calcula ya fuera del mutex del shard
+    char etag[19];
+    std::snprintf(etag, sizeof(etag), "\"%016llx\"",
+                  static_cast<unsigned long long>(fnv1a64(snapshot->json.data(), snapshot->json.size())));
+    snapshot->etag = etag;
+
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    auto published = std::atomic_load(&list_snapshot_);
+    if (published && published->version >= snapshot->version) return;
+    std::atomic_store(&list_snapshot_, std::shared_ptr<const AlarmListSnapshot>(std::move(snapshot)));
+}
+
+bool AlarmShard::readAlarmPage(const AlarmQuery& query, std::string& cursor,
+                               size_t max_records, std::string& out, size_t& emitted) {
+    // Tope de alarmas revisadas por llamada: con filtros muy selectivos
+    // el recorrido se reparte en varias tomas cortas del mutex
+    const size_t max_scanned = 4096;
+
+    touch();
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+
+    auto it = cursor.empty() ? id_order_.begin()
+                             : id_order_.upper_bound(AlarmId::fromString(cursor));
+    size_t scanned = 0;
+    size_t written = 0;
+    const RingingIds ringing = (query.fields & AlarmQuery::FIELD_RINGING) ? hooks_.ringing_ids(name_)
+                                                                          : RingingIds();
+
+    for (; it != id_order_.end() && written < max_records && scanned < max_scanned; ++it) {
+        scanned++;
+        // Primero lo que está en la parte caliente; la fría sólo si pasa
+        const AlarmTiming* timing = timing_.get(it->second);
+        if (query.enabled && timing->enabled != *query.enabled) continue;
+        if (!query.matchesHour(timing->hour)) continue;
+
+        const std::string& label = details_[it->second.index].label;
+        if (label.compare(0, query.label_prefix.size(), query.label_prefix) != 0) continue;
+
+        if (emitted > 0) out += ',';
+        appendAlarmJson(it->second, query.fields, ringing, out);
+        emitted++;
+        written++;
+    }
+
+    if (scanned > 0) {
+        cursor = std::prev(it)->first.toString();
+    }
+    return it != id_order_.end();
+}
+
+void AlarmShard::appendAlarmJson(SlotHandle handle, uint32_t fields, const RingingIds& ringing,
+                                 std::string& out) const {
+    const AlarmTiming& timing = *timing_.get(handle);
+    const AlarmDetails& details = details_[handle.index];
+
+    bool first = true;
+    out += '{';
+    AlarmCodec::appendFields(out, timing, details, fields, first);
+
+    // Campos que no se guardan: dependen del estado del servidor
+    if (fields & AlarmQuery::FIELD_RINGING) {
+        out += first ? "\"ringing\":" : ",\"ringing\":";
+        appendJsonBool(out, ringing.count(details.id) > 0);
+        first = false;
+    }
+    if (fields & AlarmQuery::FIELD_NEXT_FIRE) {
+        out += first ? "\"next_fire\":" : ",\"next_fire\":";
+        out += timing.next_fire < 0 ? "null" : std::to_string(timing.next_fire);
+    }
+    out += '}';
+}
+
+void AlarmShard::invalidateAlarmList() {
+    list_version_.fetch_add(1);
+    hooks_.list_stale(name_);
+}
+
+void AlarmShard::appendAlarmListLocked(std::string& out) const {
+    // Con el mutex del shard tomado: una sesión que empiece después
+    // invalida esta versión de la lista
+    const RingingIds ringing = hooks_.ringing_ids(name_);
+
+    out += '[';
+    bool first = true;
+    for (size_t i = 0; i < timing_.size(); i++) {
+        if (!first) out += ',';
+        appendAlarmJson(timing_.handleAt(i), AlarmQuery::ALL_FIELDS, ringing, out);
+        first = false;
+    }
+    out += ']';
+}
+
+bool AlarmShard::nextDue(std::time_t& due, std::string* sound_file) {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+
+    SlotHandle next;
+    if (!scheduler_.nextDue(due, next)) return false;
+    if (sound_file) {
+        if (timing_.contains(next)) *sound_file = details_[next.index].sound_file;
+    }
+    return true;
+}
+
+std::vector<AlarmShard::Fired> AlarmShard::popDue(std::time_t now) {
+    std::vector<Fired> fired;
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+
+    for (const auto& entry : scheduler_.popDue(now)) {
+        // Un handle de una alarma ya borrada no pasa la comprobación de generación
+        AlarmTiming* timing = timing_.get(entry.alarm);
+        if (!timing || !timing->enabled) continue;
+
+        fired.push_back({assembleLocked(entry.alarm), entry.due});
+
+        // Siguiente disparo según la regla, a partir del minuto siguiente
+        const AlarmDetails& details = details_[entry.alarm.index];
+        scheduleAlarm(entry.alarm, *timing, details.repeat, now + 60);
+        if (timing->next_fire < 0) {
+            // Fechas sueltas agotadas: queda desactivada, como una alarma
+            // de una sola vez
+            timing->enabled = false;
+            storage_.appendPut(assembleLocked(entry.alarm));
+            Logger::info("Alarma " + details.id.toString() + " sin más fechas: desactivada");
+        }
+    }
+
+    // Siempre: quien llama espera que el primer disparo avance
+    reportDueLocked(true);
+    return fired;
+}
+
+void AlarmShard::scheduleAlarm(SlotHandle handle, AlarmTiming& timing, const Recurrence& repeat,
+                               std::time_t from) {
+    timing.next_fire = repeat.nextFire(timing.hour, timing.minute, from);
+    if (timing.next_fire < 0) {
+        scheduler_.cancel(handle);
+    } else {
+        scheduler_.schedule(handle, timing.next_fire);
+    }
+}
+
+SlotHandle AlarmShard::insertLocked(Alarm alarm) {
+    SlotHandle handle = timing_.insert(alarm);
+    if (handle.index >= details_.size()) details_.resize(handle.index + 1);
+    details_[handle.index] = std::move(static_cast<AlarmDetails&>(alarm));
+
+    alarm_index_.emplace(details_[handle.index].id, handle);
+    id_order_.emplace(details_[handle.index].id, handle);
+    return handle;
+}
+
+Alarm AlarmShard::assembleLocked(SlotHandle handle) const {
+    Alarm alarm;
+    static_cast<AlarmTiming&>(alarm) = *timing_.get(handle);
+    static_cast<AlarmDetails&>(alarm) = details_[handle.index];
+    return alarm;
+}
+
+std::vector<Alarm> AlarmShard::allAlarmsLocked() const {
+    std::vector<Alarm> alarms;
+    alarms.reserve(timing_.size());
+    for (size_t i = 0; i < timing_.size(); i++) {
+        alarms.push_back(assembleLocked(timing_.handleAt(i)));
+    }
+    return alarms;
+}
+
+void AlarmShard::reportDueLocked(bool force) {
+    std::time_t due = -1;
+    if (!scheduler_.nextDue(due)) due = -1;
+    if (due == reported_due_ && !force) return;
+
+    reported_due_ = due;
+    hooks_.due_changed(name_, due);
+}
+
+size_t AlarmShard::getAlarmCount() {
+    std::lock_guard<InstrumentedMutex> lock(mutex_);
+    return timing_.size();
+}
+
+AlarmStorage::Stats AlarmShard::getStorageStats() {
+    return storage_.stats();
+}
+
+bool AlarmShard::flush() {
+    return storage_.flush();
+}
+
+void AlarmShard::touch() {
+    last_used_.store(clock_->time(), std::memory_order_relaxed);
+}
@@ -0,0 +1,163 @@
+#ifndef ALARM_SHARD_H
+#define ALARM_SHARD_H
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <map>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <ctime>
+#include <nlohmann/json.hpp>
+#include "../models/Alarm.h"
+#include "../models/AlarmStorage.h"
+#include "../models/AlarmOperation.h"
+#include "../models/AlarmQuery.h"
+#include "../utils/SlotMap.h"
+#include "../utils/InstrumentedMutex.h"
+#include "../utils/Clock.h"
+#include "AlarmScheduler.h"
+
+// Lista de alarmas ya serializada, inmutable una vez publicada
+struct AlarmListSnapshot {
+    uint64_t version;
+    std::string json;
+    std::string etag;  // ETag fuerte: hash del contenido
+};
+
+// Las alarmas de un namespace (usuario o dispositivo): su propio mutex, su
+// propio fichero de datos y su propio heap de disparos. Un cambio en un
+// shard no bloquea lecturas ni disparos de otro. AlarmManager se entera de
+// lo que le importa por los Hooks; el orden de bloqueo es siempre shard ->
+// (lo que tomen los hooks), nunca al revés.
+class AlarmShard {
+public:
+    using RingingIds = std::unordered_set<AlarmId, AlarmIdHash>;
+
+    struct Hooks {
+        // Alarmas del namespace que están sonando (para el campo "ringing"
+        // de la lista): se pide una vez por lista, no una por alarma
+        std::function<RingingIds(const std::string& ns)> ringing_ids;
+        // El primer disparo del shard cambió; -1 si no tiene ninguno
+        std::function<void(const std::string& ns, std::time_t due)> due_changed;
+        // Cambió la lista y la publicada quedó vieja: alguien tiene que
+        // llamar a publishAlarmList(). Puede llegar con el mutex del shard
+        // tomado, así que no debe publicarla en este hilo
+        std::function<void(const std::string& ns)> list_stale;
+    };
+
+    // Alarma que acaba de dispararse (copia: la original puede cambiar en
+    // cuanto se suelta el mutex)
+    struct Fired {
+        Alarm alarm;
+        std::time_t due;
+    };
+
+    AlarmShard(std::string name, const std::string& storage_path,
+               std::shared_ptr<Clock> clock, Hooks hooks);
+    ~AlarmShard();
+
+    AlarmShard(const AlarmShard&) = delete;
+    AlarmShard& operator=(const AlarmShard&) = delete;
+
+    const std::string& name() const { return name_; }
+
+    // Lee snapshot + journal y programa las alarmas; sólo la primera vez
+    void load();
+    // Arranca / detiene el hilo escritor de su AlarmStorage
+    void start();
+    void stop();
+
+    // Todas las operaciones bajo un único bloqueo y con un único commit
+    std::vector<AlarmOperationResult> applyBatch(const std::vector<AlarmOperation>& ops,
+                                                 std::time_t now);
+
+    // La lista actual como DOM (herramientas y benchmarks)
+    nlohmann::json getAllAlarms();
+    // La última lista publicada: una carga atómica, sin el mutex del shard.
+    // Tras un cambio va por detrás hasta la siguiente publishAlarmList()
+    std::shared_ptr<const AlarmListSnapshot> getAlarmListSnapshot();
+    // Regenera y publica la lista si su versión quedó vieja; devuelve la
+    // versión publicada o 0 si ya estaba al día
+    uint64_t publishAlarmList();
+    bool readAlarmPage(const AlarmQuery& query, std::string& cursor,
+                       size_t max_records, std::string& out, size_t& emitted);
+
+    // Cambia la versión de la lista sin tocar las alarmas (p.ej. empezó a
+    // sonar una: cambia su campo "ringing") y avisa por list_stale
+    void invalidateAlarmList();
+
+    // Primer disparo programado y su sonido (para pre-armar el audio)
+    bool nextDue(std::time_t& due, std::string* sound_file = nullptr);
+    // Saca las alarmas vencidas y programa su siguiente disparo; las que ya
+    // no tienen más días quedan desactivadas
+    std::vector<Fired> popDue(std::time_t now);
+
+    size_t getAlarmCount();
+    AlarmStorage::Stats getStorageStats();
+    // false si el journal no se pudo escribir (ver AlarmStorage::flush)
+    bool flush();
+
+    // Último acceso desde la API, para descargar los shards sin uso
+    std::time_t lastUsed() const { return last_used_.load(std::memory_order_relaxed); }
+
+private:
+    AlarmOperationResult applyOperationLocked(const AlarmOperation& op,
+                                              AlarmStorage::Batch& batch,
+                                              std::time_t now);
+    // Calcula timing.next_fire desde `from` y lo programa (o lo quita del
+    // scheduler si la regla ya no tiene más días)
+    void scheduleAlarm(SlotHandle handle, AlarmTiming& timing, const Recurrence& repeat,
+                       std::time_t from);
+    // Inserta las dos partes; devuelve el handle de timing_
+    SlotHandle insertLocked(Alarm alarm);
+    // Vuelve a juntar las dos partes (para copias que salen del mutex)
+    Alarm assembleLocked(SlotHandle handle) const;
+    std::vector<Alarm> allAlarmsLocked() const;
+    void reportDueLocked(bool force = false);
+    void touch();
+    // Lista completa como array JSON, escrita directamente desde las alarmas
+    void appendAlarmListLocked(std::string& out) const;
+    // Guarda `snapshot` salvo que ya haya una versión igual o más nueva
+    void storeAlarmList(std::shared_ptr<AlarmListSnapshot> snapshot);
+    void appendAlarmJson(SlotHandle handle, uint32_t fields, const RingingIds& ringing,
+                         std::string& out) const;
+
+    const std::string name_;
+    const std::shared_ptr<Clock> clock_;
+    const Hooks hooks_;
+    InstrumentedMutex mutex_{"alarms"};
+    std::once_flag loaded_;
+    std::atomic<bool> started_{false};
+
+    // Parte caliente de las alarmas, contigua en memoria: el scheduler y
+    // los filtros de la paginación sólo recorren esto (16 B por alarma).
+    // La parte fría va aparte, indexada por el slot del handle.
+    SlotMap<AlarmTiming> timing_;
+    std::vector<AlarmDetails> details_;
+    // Índice id -> handle para que las operaciones por id sean O(1) y no
+    // alarguen la sección crítica
+    std::unordered_map<AlarmId, SlotHandle, AlarmIdHash> alarm_index_;
+
+    // Ids ordenados para paginar por cursor
+    std::map<AlarmId, SlotHandle> id_order_;
+
+    AlarmStorage storage_;
+    AlarmScheduler scheduler_;
+    // Último valor avisado por due_changed, para no avisar si no cambia
+    std::time_t reported_due_ = -1;
+
+    // Cada cambio visible en la lista incrementa list_version_; la copia
+    // publicada la regenera quien atienda list_stale, nunca un lector.
+    // publish_mutex_ sólo ordena a los que publican
+    std::atomic<uint64_t> list_version_{1};
+    std::mutex publish_mutex_;
+    std::shared_ptr<const AlarmListSnapshot> list_snapshot_;
+
+    std::atomic<std::time_t> last_used_{0};
+};
+
+#endif
@@ -0,0 +1,209 @@
+#include "AudioBackend.h"
+#include "../utils/Logger.h"
+#include "../utils/Process.h"
+#include "../utils/Metrics.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+const char* const TERMUX_BIN = "/data/data/com.termux/files/usr/bin";
+const char* const DEFAULT_SOUND = "/data/data/com.termux/files/home/bellaciao.wav";
+
+// Un método se descarta tras estos fallos seguidos
+const int MAX_FAILURES = 2;
+
+std::string findTermuxTool(const std::string& name) {
+    std::string path = Process::findExecutable(name);
+    if (path.empty()) {
+        std::string fallback = std::string(TERMUX_BIN) + "/" + name;
+        if (::access(fallback.c_str(), X_OK) == 0) {
+            path = fallback;
+        }
+    }
+    return path;
+}
+
+// Comando de termux que no terminó bien (no existe, timeout o código != 0)
+void countSpawnFailure(const std::string& executable) {
+    std::string tool = executable.substr(executable.find_last_of('/') + 1);
+    Metrics::counter("wake_audio_spawn_failures_total",
+                     "Comandos de sonido/vibración que fallaron",
+                     "tool=\"" + tool + "\"").inc();
+}
+
+}
+
+std::unique_ptr<AudioBackend> AudioBackend::detect() {
+    const char* forced = std::getenv("WAKE_AUDIO_BACKEND");
+    if (forced != nullptr) {
+        if (std::strcmp(forced, "termux") == 0) return std::make_unique<TermuxAudioBackend>();
+        if (std::strcmp(forced, "console") == 0) return std::make_unique<ConsoleAudioBackend>();
+        if (std::strcmp(forced, "null") == 0) return std::make_unique<NullAudioBackend>();
+        Logger::warning("⚠️  WAKE_AUDIO_BACKEND desconocido: " + std::string(forced));
+    }
+
+    if (TermuxAudioBackend::isAvailable()) {
+        return std::make_unique<TermuxAudioBackend>();
+    }
+    return std::make_unique<NullAudioBackend>();
+}
+
+bool TermuxAudioBackend::isAvailable() {
+    // 1. Variable de entorno TERMUX_VERSION
+    if (std::getenv("TERMUX_VERSION") != nullptr) {
+        return true;
+    }
+
+    // 2. Directorio de Termux
+    if (::access((std::string(TERMUX_BIN) + "/termux-info").c_str(), F_OK) == 0) {
+        return true;
+    }
+
+    // 3. termux-api en el PATH
+    return !Process::findExecutable("termux-vibrate").empty();
+}
+
+TermuxAudioBackend::TermuxAudioBackend() {
+    const struct { Method method; const char* tool; } METHODS[] = {
+        {Method::MediaPlayer, "termux-media-player"},
+        {Method::Speak, "termux-tts-speak"},
+        {Method::Notification, "termux-notification"},
+        {Method::Bell, "tput"},
+    };
+
+    for (const auto& entry : METHODS) {
+        std::string executable = findTermuxTool(entry.tool);
+        if (!executable.empty()) {
+            candidates_.push_back({entry.method, executable});
+        }
+    }
+
+    vibrate_executable_ = findTermuxTool("termux-vibrate");
+    vibrate_disabled_ = vibrate_executable_.empty();
+}
+
+std::string TermuxAudioBackend::resolveSoundFile(const std::string& sound_file) {
+    return (!sound_file.empty() && sound_file[0] == '/') ? sound_file : DEFAULT_SOUND;
+}
+
+void TermuxAudioBackend::prepare(const std::string& sound_file) {
+    std::string file = resolveSoundFile(sound_file);
+
+    // Traer el WAV a la caché de páginas: el primer play no toca disco
+    int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (missing_sound_ != file) {
+            Logger::warning("⚠️  Fichero de sonido no disponible: " + file);
+            missing_sound_ = file;
+        }
+    } else {
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+        char buffer[64 * 1024];
+        while (::read(fd, buffer, sizeof(buffer)) > 0) {}
+        ::close(fd);
+        missing_sound_.clear();
+    }
+
+    // Despertar el servicio de termux-api (el primer comando tras un rato
+    // inactivo es el que tarda) y dejar el ejecutable en caché
+    for (const auto& candidate : candidates_) {
+        if (candidate.method == Method::MediaPlayer) {
+            if (Process::run({candidate.executable, "info"}, std::chrono::seconds(3)) != 0) {
+                countSpawnFailure(candidate.executable);
+            }
+            break;
+        }
+    }
+}
+
+std::vector<std::string> TermuxAudioBackend::commandFor(const Candidate& candidate,
+                                                        const std::string& sound_file) const {
+    switch (candidate.method) {
+        case Method::MediaPlayer:
+            return {candidate.executable, "play", resolveSoundFile(sound_file)};
+        case Method::Speak:
+            return {candidate.executable, "Alarma"};
+        case Method::Notification:
+            return {candidate.executable, "--sound", "--title", "Alarma", "--content", "¡Despertador!"};
+        case Method::Bell:
+            return {candidate.executable, "bel"};
+    }
+    return {};
+}
+
+bool TermuxAudioBackend::beep(const std::string& sound_file) {
+    for (auto it = candidates_.begin(); it != candidates_.end();) {
+        if (Process::run(commandFor(*it, sound_file)) == 0) {
+            it->failures = 0;
+            return true;
+        }
+
+        countSpawnFailure(it->executable);
+        if (++it->failures >= MAX_FAILURES) {
+            Logger::warning("⚠️  Método de sonido descartado: " + it->executable);
+            it = candidates_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Fallback: alerta visual en consola
+    std::cout << "\n\n🔔🔔🔔 ¡ALARMA SONANDO! 🔔🔔🔔\n" << std::flush;
+    return false;
+}
+
+bool TermuxAudioBackend::vibrate(int duration_ms) {
+    if (vibrate_disabled_) return false;
+
+    if (Process::run({vibrate_executable_, "-d", std::to_string(duration_ms)}) == 0) {
+        vibrate_failures_ = 0;
+        return true;
+    }
+    countSpawnFailure(vibrate_executable_);
+    if (++vibrate_failures_ >= MAX_FAILURES) {
+        Logger::warning("⚠️  Vibración descartada: termux-vibrate falla");
+        vibrate_disabled_ = true;
+    }
+    return false;
+}
+
+bool ConsoleAudioBackend::beep(const std::string&) {
+    std::cout << "\a\n🔔🔔🔔 ¡ALARMA SONANDO! 🔔🔔🔔\n" << std::flush;
+    return true;
+}
+
+bool ConsoleAudioBackend::vibrate(int) {
+    return false;
+}
+
+void RecordingAudioBackend::prepare(const std::string& sound_file) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.push_back("prepare:" + sound_file);
+}
+
+bool RecordingAudioBackend::beep(const std::string& sound_file) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.push_back("beep:" + sound_file);
+    return true;
+}
+
+bool RecordingAudioBackend::vibrate(int duration_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.push_back("vibrate:" + std::to_string(duration_ms));
+    return true;
+}
+
+std::vector<std::string> RecordingAudioBackend::events() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_;
+}
+
+void RecordingAudioBackend::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.clear();
+}
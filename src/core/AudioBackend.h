@@ -0,0 +1,101 @@
+#ifndef AUDIO_BACKEND_H
+#define AUDIO_BACKEND_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+// Forma de hacer sonar/vibrar la alarma. AudioPlayer elige una al arrancar
+// y la usa en cada repetición del bucle de reproducción.
+class AudioBackend {
+public:
+    virtual ~AudioBackend() = default;
+
+    virtual const char* name() const = 0;
+
+    // false si el backend no produce sonido real (null, consola)
+    virtual bool audible() const { return true; }
+
+    // Pre-armado antes de la próxima alarma: resolver el fichero, cargarlo
+    // en memoria y despertar los auxiliares, para que beep() solo arranque
+    virtual void prepare(const std::string&) {}
+
+    // Una repetición del sonido de alarma
+    virtual bool beep(const std::string& sound_file) = 0;
+    virtual bool vibrate(int duration_ms) = 0;
+
+    // Elige el mejor backend disponible. Solo mira el entorno y el PATH,
+    // no lanza procesos. WAKE_AUDIO_BACKEND=termux|console|null lo fuerza.
+    static std::unique_ptr<AudioBackend> detect();
+};
+
+// termux-api: media-player, tts, notificación y, como último recurso,
+// el timbre del terminal. Los métodos que fallan se descartan para no
+// volver a lanzarlos en cada repetición.
+class TermuxAudioBackend : public AudioBackend {
+public:
+    static bool isAvailable();
+
+    TermuxAudioBackend();
+
+    const char* name() const override { return "termux"; }
+    void prepare(const std::string& sound_file) override;
+    bool beep(const std::string& sound_file) override;
+    bool vibrate(int duration_ms) override;
+
+private:
+    enum class Method { MediaPlayer, Speak, Notification, Bell };
+
+    struct Candidate {
+        Method method;
+        std::string executable;
+        int failures = 0;
+    };
+
+    static std::string resolveSoundFile(const std::string& sound_file);
+    std::vector<std::string> commandFor(const Candidate& candidate,
+                                        const std::string& sound_file) const;
+
+    std::vector<Candidate> candidates_;
+    std::string missing_sound_;  // último fichero no encontrado (aviso una vez)
+    std::string vibrate_executable_;
+    bool vibrate_disabled_{false};
+    int vibrate_failures_{0};
+};
+
+// Sin sonido: avisa por la salida estándar
+class ConsoleAudioBackend : public AudioBackend {
+public:
+    const char* name() const override { return "console"; }
+    bool audible() const override { return false; }
+    bool beep(const std::string& sound_file) override;
+    bool vibrate(int duration_ms) override;
+};
+
+class NullAudioBackend : public AudioBackend {
+public:
+    const char* name() const override { return "null"; }
+    bool audible() const override { return false; }
+    bool beep(const std::string&) override { return true; }
+    bool vibrate(int) override { return true; }
+};
+
+// Guarda lo que se habría hecho ("prepare:<fichero>", "beep:<fichero>",
+// "vibrate:<ms>"), para comprobarlo sin dispositivo
+class RecordingAudioBackend : public AudioBackend {
+public:
+    const char* name() const override { return "recording"; }
+    void prepare(const std::string& sound_file) override;
+    bool beep(const std::string& sound_file) override;
+    bool vibrate(int duration_ms) override;
+
+    std::vector<std::string> events() const;
+    void clear();
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<std::string> events_;
+};
+
+#endif
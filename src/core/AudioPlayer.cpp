@@ -1,114 +1,155 @@
 #include "AudioPlayer.h"
 #include "../utils/Logger.h"
-#include <cstdlib>
-#include <iostream>
-#include <chrono>
-#include <fstream>
+#include <algorithm>
+#include <cstdio>
 
-AudioPlayer::AudioPlayer() {
-    is_termux_ = isTermuxEnvironment();
-    if (is_termux_) {
-        Logger::info("✅ Entorno Termux detectado - Sonido habilitado");
-    } else {
-        Logger::warning("⚠️  No se detectó Termux - Sonido deshabilitado");
-    }
+AudioPlayer::AudioPlayer(std::shared_ptr<Clock> clock)
+    : clock_(std::move(clock)) {
+    backend_ = std::async(std::launch::async, []() -> std::shared_ptr<AudioBackend> {
+        std::shared_ptr<AudioBackend> backend = AudioBackend::detect();
+        if (backend->audible()) {
+            Logger::info(std::string("✅ Backend de sonido: ") + backend->name());
+        } else {
+            Logger::warning(std::string("⚠️  Backend de sonido: ") + backend->name() +
+                            " - Sonido deshabilitado");
+        }
+        return backend;
+    }).share();
+    
+    worker_ = std::thread(&AudioPlayer::workerLoop, this);
 }
 
-AudioPlayer::~AudioPlayer() {
-    stop();
+AudioPlayer::AudioPlayer(std::shared_ptr<AudioBackend> backend, std::shared_ptr<Clock> clock)
+    : clock_(std::move(clock)) {
+    std::promise<std::shared_ptr<AudioBackend>> ready;
+    ready.set_value(std::move(backend));
+    backend_ = ready.get_future().share();
+    
+    worker_ = std::thread(&AudioPlayer::workerLoop, this);
 }
 
-bool AudioPlayer::isTermuxEnvironment() {
-    // Verificar si estamos en Termux
-    // 1. Verificar variable de entorno TERMUX_VERSION
-    if (std::getenv("TERMUX_VERSION") != nullptr) {
-        return true;
-    }
-    
-    // 2. Verificar si existe el directorio de Termux
-    std::ifstream termux_check("/data/data/com.termux/files/usr/bin/termux-info");
-    if (termux_check.good()) {
-        termux_check.close();
-        return true;
+AudioPlayer::~AudioPlayer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+        playing_ = false;
     }
-    
-    // 3. Verificar si termux-api está disponible
-    int result = system("command -v termux-vibrate >/dev/null 2>&1");
-    if (result == 0) {
-        return true;
+    cv_.notify_all();
+    worker_.join();
+}
+
+void AudioPlayer::arm(const std::string& sound_file) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (armed_file_ == sound_file || (arm_requested_ && arm_file_ == sound_file)) {
+            return;
+        }
+        arm_file_ = sound_file;
+        arm_requested_ = true;
     }
-    
-    return false;
+    cv_.notify_all();
 }
 
 void AudioPlayer::play(const std::string& sound_file, bool vibrate) {
-    if (!is_termux_) {
-        Logger::info("🔇 Alarma activada (sin sonido - no Termux)");
-        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sound_file_ = sound_file;
+        use_vibration_ = vibrate;
+        trigger_time_ = clock_->steadyNow();
+        play_requested_ = true;
+        playing_ = true;
     }
-    
-    if (playing_) {
-        stop();
-    }
-    
-    playing_ = true;
-    use_vibration_ = vibrate;
-    
-    play_thread_ = std::thread(&AudioPlayer::playLoop, this);
+    cv_.notify_all();
 }
 
 void AudioPlayer::stop() {
+    std::unique_lock<std::mutex> lock(mutex_);
     playing_ = false;
-    if (play_thread_.joinable()) {
-        play_thread_.join();
+    play_requested_ = false;
+    cv_.notify_all();
+    
+    // Al volver, el sonido ya está parado
+    cv_.wait(lock, [this] { return !ringing_; });
+}
+
+AudioPlayer::LatencyStats AudioPlayer::latencyStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return latency_;
+}
+
+void AudioPlayer::workerLoop() {
+    std::shared_ptr<AudioBackend> backend = backend_.get();
+    
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return shutdown_ || arm_requested_ || play_requested_; });
+        if (shutdown_) break;
+        
+        if (play_requested_) {
+            ringing_ = true;
+            ringLoop(lock, *backend);
+            ringing_ = false;
+            cv_.notify_all();
+            continue;
+        }
+        
+        arm_requested_ = false;
+        std::string file = arm_file_;
+        lock.unlock();
+        backend->prepare(file);
+        lock.lock();
+        armed_file_ = file;
     }
 }
 
-void AudioPlayer::playLoop() {
-    Logger::info("🔊 Reproduciendo alarma en el servidor (Termux)...");
+void AudioPlayer::ringLoop(std::unique_lock<std::mutex>& lock, AudioBackend& backend) {
+    if (backend.audible()) {
+        Logger::info(std::string("🔊 Reproduciendo alarma en el servidor (") + backend.name() + ")...");
+    } else {
+        Logger::info(std::string("🔇 Alarma activada (sin sonido - ") + backend.name() + ")");
+    }
     
     int beep_count = 0;
     
-    while (playing_) {
-        // Intentar reproducir sonido usando Termux API
-        if (!playBeep()) {
-            // Fallback: alerta visual en consola
-            std::cout << "\n\n🔔🔔🔔 ¡ALARMA SONANDO! 🔔🔔🔔\n" << std::flush;
+    while (playing_ && !shutdown_) {
+        bool first = play_requested_;
+        bool armed = first && !armed_file_.empty() && armed_file_ == sound_file_;
+        if (first) {
+            // Nuevo disparo (también si llega otro mientras ya suena)
+            play_requested_ = false;
+            armed_file_.clear();
+            beep_count = 0;
         }
+        std::string file = sound_file_;
+        bool vibrate = use_vibration_;
+        auto trigger = trigger_time_;
         
-        // Vibración (si termux-vibrate está disponible)
-        if (use_vibration_ && beep_count % 2 == 0) {
-            triggerVibration();
+        lock.unlock();
+        backend.beep(file);
+        auto audible_at = clock_->steadyNow();
+        if (vibrate && beep_count % 2 == 0) {
+            backend.vibrate(500);
+        }
+        lock.lock();
+        
+        if (first) {
+            double ms = std::chrono::duration<double, std::milli>(audible_at - trigger).count();
+            latency_.samples++;
+            latency_.last_ms = ms;
+            latency_.max_ms = std::max(latency_.max_ms, ms);
+            latency_.total_ms += ms;
+            latency_.last_armed = armed;
+            
+            char message[96];
+            std::snprintf(message, sizeof(message), "⏱️  Latencia disparo→sonido: %.1f ms (%s)",
+                          ms, armed ? "pre-armado" : "en frío");
+            Logger::info(message);
         }
         
         beep_count++;
-        std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+        cv_.wait_until(lock, clock_->realTime(clock_->now() + std::chrono::milliseconds(1500)),
+                       [this] { return !playing_ || shutdown_ || play_requested_; });
     }
     
     Logger::info("🔇 Reproducción detenida");
 }
-
-bool AudioPlayer::playBeep() {
-    // Método 1: Usar termux-media-player con archivo de sistema
-    int result = system("termux-media-player play /data/data/com.termux/files/home/bellaciao.wav 2>/dev/null");
-    if (result == 0) return true;
-    
-    // Método 2: Usar termux-tts (text-to-speech)
-    result = system("termux-tts-speak 'Alarma' 2>/dev/null");
-    if (result == 0) return true;
-    
-    // Método 3: Usar termux-notification con sonido
-    result = system("termux-notification --sound --title 'Alarma' --content '¡Despertador!' 2>/dev/null");
-    if (result == 0) return true;
-    
-    // Método 4: Beep del sistema
-    result = system("tput bel 2>/dev/null");
-    if (result == 0) return true;
-    
-    return false;
-}
-
-void AudioPlayer::triggerVibration() {
-    // Vibración por 500ms
-    system("termux-vibrate -d 500 2>/dev/null");
-}
\ No newline at end of file
@@ -4,26 +4,69 @@
 #include <string>
 #include <atomic>
 #include <thread>
+#include <memory>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include "AudioBackend.h"
+#include "../utils/Clock.h"
 
+// Reproduce la alarma desde un hilo que vive todo el tiempo: play() solo
+// le avisa, y arm() le deja preparado el sonido de la próxima alarma.
 class AudioPlayer {
 public:
-    AudioPlayer();
+    // Latencia entre play() y el primer sonido reproducido
+    struct LatencyStats {
+        uint64_t samples = 0;
+        double last_ms = 0;
+        double max_ms = 0;
+        double total_ms = 0;
+        bool last_armed = false;  // si el último disparo estaba pre-armado
+    };
+    
+    // Detecta el backend en segundo plano, fuera del arranque
+    explicit AudioPlayer(std::shared_ptr<Clock> clock = Clock::system());
+    // Backend fijo (p.ej. RecordingAudioBackend en pruebas)
+    explicit AudioPlayer(std::shared_ptr<AudioBackend> backend,
+                         std::shared_ptr<Clock> clock = Clock::system());
     ~AudioPlayer();
     
+    // Prepara el sonido de la próxima alarma (no bloquea)
+    void arm(const std::string& sound_file);
     void play(const std::string& sound_file, bool vibrate);
     void stop();
     bool isPlaying() const { return playing_; }
     
+    LatencyStats latencyStats() const;
+    
+    // Espera a que termine la detección si aún no ha terminado
+    std::shared_ptr<AudioBackend> backend() const { return backend_.get(); }
+    
 private:
-    void playLoop();
-    void triggerVibration();
-    bool playBeep();
-    bool isTermuxEnvironment();
+    void workerLoop();
+    void ringLoop(std::unique_lock<std::mutex>& lock, AudioBackend& backend);
     
-    std::atomic<bool> playing_{false};
-    std::thread play_thread_;
+    std::shared_future<std::shared_ptr<AudioBackend>> backend_;
+    // Marca el ritmo de los pitidos y mide la latencia
+    const std::shared_ptr<Clock> clock_;
+    std::thread worker_;
+    
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool shutdown_{false};
+    bool arm_requested_{false};
+    bool play_requested_{false};
+    bool ringing_{false};
+    std::string arm_file_;
+    std::string armed_file_;  // preparado y aún sin usar
+    std::string sound_file_;
     bool use_vibration_{false};
-    bool is_termux_{false};
+    std::chrono::steady_clock::time_point trigger_time_;
+    LatencyStats latency_;
+    
+    std::atomic<bool> playing_{false};
 };
 
-#endif
\ No newline at end of file
+#endif
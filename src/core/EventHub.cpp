@@ -0,0 +1,111 @@
+#include "EventHub.h"
+
+EventHub::EventHub(size_t max_subscribers, size_t queue_capacity)
+    : max_subscribers_(max_subscribers), queue_capacity_(queue_capacity) {}
+
+std::shared_ptr<EventHub::Subscription> EventHub::subscribe() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_ || subscribers_.size() >= max_subscribers_) {
+        return nullptr;
+    }
+    
+    auto subscription = std::make_shared<Subscription>();
+    subscribers_.push_back(subscription);
+    return subscription;
+}
+
+void EventHub::unsubscribe(const std::shared_ptr<Subscription>& subscription) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    subscribers_.remove(subscription);
+}
+
+void EventHub::publish(const std::string& type, const std::string& data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (subscribers_.empty()) return;
+    
+    auto event = std::make_shared<const Subscription::Event>(
+        Subscription::Event{++next_event_id_, type, data});
+    for (auto& subscriber : subscribers_) {
+        subscriber->push(event, queue_capacity_);
+    }
+}
+
+void EventHub::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    for (auto& subscriber : subscribers_) {
+        subscriber->close();
+    }
+}
+
+size_t EventHub::subscriberCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return subscribers_.size();
+}
+
+std::string EventHub::format(uint64_t id, const std::string& type, const std::string& data) {
+    std::string chunk;
+    chunk.reserve(type.size() + data.size() + 32);
+    if (id > 0) {
+        chunk += "id: " + std::to_string(id) + "\n";
+    }
+    chunk += "event: " + type + "\n";
+    chunk += "data: " + data + "\n\n";
+    return chunk;
+}
+
+void EventHub::Subscription::push(const std::shared_ptr<const Event>& event, size_t capacity) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        // Varios list-changed seguidos sin leer equivalen a uno solo
+        if (event->type == "list-changed" && !queue_.empty() &&
+            queue_.back()->type == "list-changed") {
+            return;
+        }
+        
+        if (queue_.size() >= capacity) {
+            queue_.pop_front();
+            overflowed_ = true;
+        }
+        queue_.push_back(event);
+    }
+    cv_.notify_one();
+}
+
+void EventHub::Subscription::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    cv_.notify_all();
+}
+
+bool EventHub::Subscription::next(std::string& chunk, std::chrono::milliseconds heartbeat) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    
+    cv_.wait_for(lock, heartbeat, [this] { return closed_ || overflowed_ || !queue_.empty(); });
+    if (closed_) return false;
+    
+    if (overflowed_) {
+        // Se perdieron eventos: el cliente debe recargar todo
+        overflowed_ = false;
+        queue_.clear();
+        chunk = EventHub::format(0, "resync", "{}");
+        return true;
+    }
+    
+    if (queue_.empty()) {
+        chunk = ": ping\n\n";
+        return true;
+    }
+    
+    // Entregar todo lo acumulado en un único chunk
+    chunk.clear();
+    while (!queue_.empty()) {
+        const auto& event = queue_.front();
+        chunk += EventHub::format(event->id, event->type, event->data);
+        queue_.pop_front();
+    }
+    return true;
+}
@@ -0,0 +1,72 @@
+#ifndef EVENT_HUB_H
+#define EVENT_HUB_H
+
+#include <string>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+// Reparto de eventos del servidor (alarm-fired, alarm-stopped,
+// list-changed...) a los clientes conectados a /api/events (SSE).
+// Cada suscriptor tiene una cola acotada: si un cliente lento la llena se
+// descartan los eventos más antiguos y recibe un "resync" para que recargue
+// el estado completo, así un cliente nunca frena a los demás ni al
+// AlarmManager que publica.
+class EventHub {
+public:
+    class Subscription {
+    public:
+        // Espera al siguiente evento y lo devuelve ya formateado como SSE.
+        // Si pasa `heartbeat` sin eventos devuelve un comentario ": ping"
+        // para mantener viva la conexión. false si el hub se cerró.
+        bool next(std::string& chunk, std::chrono::milliseconds heartbeat);
+        
+    private:
+        friend class EventHub;
+        
+        struct Event {
+            uint64_t id;
+            std::string type;
+            std::string data;
+        };
+        
+        void push(const std::shared_ptr<const Event>& event, size_t capacity);
+        void close();
+        
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::deque<std::shared_ptr<const Event>> queue_;
+        bool overflowed_ = false;
+        bool closed_ = false;
+    };
+    
+    explicit EventHub(size_t max_subscribers = 4, size_t queue_capacity = 64);
+    
+    // nullptr si ya se alcanzó max_subscribers
+    std::shared_ptr<Subscription> subscribe();
+    void unsubscribe(const std::shared_ptr<Subscription>& subscription);
+    
+    // `data` debe ser JSON en una sola línea
+    void publish(const std::string& type, const std::string& data);
+    
+    // Despierta a todos los suscriptores para que terminen su stream
+    void close();
+    
+    size_t subscriberCount();
+    
+    static std::string format(uint64_t id, const std::string& type, const std::string& data);
+
+private:
+    std::mutex mutex_;
+    std::list<std::shared_ptr<Subscription>> subscribers_;
+    size_t max_subscribers_;
+    size_t queue_capacity_;
+    uint64_t next_event_id_ = 0;
+    bool closed_ = false;
+};
+
+#endif
@@ -0,0 +1,136 @@
+#include "RingSessions.h"
+#include <algorithm>
+#include <iterator>
+
+RingSessions::RingSessions(std::time_t ring_timeout)
+    : ring_timeout_(ring_timeout) {
+}
+
+void RingSessions::start(const std::string& ns, const Alarm& alarm, std::time_t now) {
+    Session* session = findMutable(ns, alarm.id);
+    if (!session) {
+        sessions_.emplace_back();
+        session = &sessions_.back();
+        session->ns = ns;
+        session->alarm_id = alarm.id;
+        session->started = now;
+    }
+
+    session->label = alarm.label;
+    session->sound_file = alarm.sound_file;
+    session->vibrate = alarm.vibrate;
+    session->state = State::Ringing;
+    session->deadline = now + ring_timeout_;
+    session->rang_at = ++ring_generation_;
+}
+
+bool RingSessions::stop(const std::string& ns, AlarmId alarm_id) {
+    auto it = std::find_if(sessions_.begin(), sessions_.end(), [&](const Session& s) {
+        return s.alarm_id == alarm_id && s.ns == ns;
+    });
+    if (it == sessions_.end()) return false;
+
+    sessions_.erase(it);
+    return true;
+}
+
+std::vector<RingSessions::Session> RingSessions::stopAll() {
+    std::vector<Session> stopped;
+    stopped.swap(sessions_);
+    return stopped;
+}
+
+std::vector<RingSessions::Session> RingSessions::stopNamespace(const std::string& ns) {
+    std::vector<Session> stopped;
+    auto it = std::stable_partition(sessions_.begin(), sessions_.end(),
+                                    [&ns](const Session& s) { return s.ns != ns; });
+    std::move(it, sessions_.end(), std::back_inserter(stopped));
+    sessions_.erase(it, sessions_.end());
+    return stopped;
+}
+
+bool RingSessions::snooze(const std::string& ns, AlarmId alarm_id,
+                          std::time_t now, std::time_t seconds) {
+    Session* session = findMutable(ns, alarm_id);
+    if (!session || session->state != State::Ringing) return false;
+
+    session->state = State::Snoozed;
+    session->deadline = now + seconds;
+    session->snoozes++;
+    return true;
+}
+
+bool RingSessions::nextDeadline(std::time_t& deadline) const {
+    if (sessions_.empty()) return false;
+
+    deadline = sessions_.front().deadline;
+    for (const auto& session : sessions_) {
+        deadline = std::min(deadline, session.deadline);
+    }
+    return true;
+}
+
+std::vector<RingSessions::Expired> RingSessions::popExpired(std::time_t now) {
+    std::vector<Expired> expired;
+
+    for (auto it = sessions_.begin(); it != sessions_.end();) {
+        if (it->deadline > now) {
+            ++it;
+            continue;
+        }
+
+        if (it->state == State::Ringing) {
+            expired.push_back({std::move(*it), true});
+            it = sessions_.erase(it);
+        } else {
+            // Fin del snooze: vuelve a sonar con un plazo nuevo
+            it->state = State::Ringing;
+            it->deadline = now + ring_timeout_;
+            it->rang_at = ++ring_generation_;
+            expired.push_back({*it, false});
+            ++it;
+        }
+    }
+    return expired;
+}
+
+bool RingSessions::isRinging(const std::string& ns, AlarmId alarm_id) const {
+    const Session* session = find(ns, alarm_id);
+    return session && session->state == State::Ringing;
+}
+
+const RingSessions::Session* RingSessions::find(const std::string& ns,
+                                                AlarmId alarm_id) const {
+    for (const auto& session : sessions_) {
+        if (session.alarm_id == alarm_id && session.ns == ns) return &session;
+    }
+    return nullptr;
+}
+
+bool RingSessions::hasNamespace(const std::string& ns) const {
+    return std::any_of(sessions_.begin(), sessions_.end(),
+                       [&ns](const Session& s) { return s.ns == ns; });
+}
+
+const RingSessions::Session* RingSessions::current() const {
+    const Session* latest = nullptr;
+    for (const auto& session : sessions_) {
+        if (session.state == State::Ringing && (!latest || session.rang_at > latest->rang_at)) {
+            latest = &session;
+        }
+    }
+    return latest;
+}
+
+size_t RingSessions::ringingCount() const {
+    return std::count_if(sessions_.begin(), sessions_.end(),
+                         [](const Session& s) { return s.state == State::Ringing; });
+}
+
+RingSessions::Session* RingSessions::findMutable(const std::string& ns,
+                                                 AlarmId alarm_id) {
+    for (auto& session : sessions_) {
+        if (session.alarm_id == alarm_id && session.ns == ns) return &session;
+    }
+    return nullptr;
+}
@@ -0,0 +1,78 @@
+#ifndef RING_SESSIONS_H
+#define RING_SESSIONS_H
+
+#include <ctime>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../models/Alarm.h"
+
+// Alarmas que están sonando o pospuestas, cada una con su propia sesión.
+// Cada sesión tiene un plazo: fin de la reproducción (auto-stop) si suena,
+// o fin del snooze si está pospuesta. No tiene hilo propio: el hilo del
+// scheduler de AlarmManager duerme también hasta nextDeadline() y llama a
+// popExpired(), así que da igual cuántas alarmas suenen a la vez.
+// Las alarmas de distintos namespaces comparten el mismo altavoz, así que
+// hay una sola RingSessions para todos; cada sesión se identifica por
+// (namespace, id). No es thread-safe: AlarmManager la protege con
+// sessions_mutex_.
+class RingSessions {
+public:
+    enum class State { Ringing, Snoozed };
+
+    struct Session {
+        std::string ns;            // "" = namespace por defecto
+        AlarmId alarm_id;
+        InternedString label;
+        InternedString sound_file;
+        bool vibrate = true;
+        State state = State::Ringing;
+        std::time_t started = 0;   // primer disparo
+        std::time_t deadline = 0;  // auto-stop o fin del snooze
+        int snoozes = 0;
+        uint64_t rang_at = 0;      // orden del último paso a Ringing
+    };
+
+    // Lo que hizo popExpired() con cada sesión vencida
+    struct Expired {
+        Session session;   // estado tras el cambio
+        bool stopped;      // true: auto-stop (ya no existe); false: vuelve a sonar
+    };
+
+    explicit RingSessions(std::time_t ring_timeout = 5 * 60);
+
+    // Empieza (o reinicia) la sesión de una alarma que acaba de dispararse
+    void start(const std::string& ns, const Alarm& alarm, std::time_t now);
+    bool stop(const std::string& ns, AlarmId alarm_id);
+    std::vector<Session> stopAll();
+    std::vector<Session> stopNamespace(const std::string& ns);
+    // Sólo una sesión que está sonando se puede posponer
+    bool snooze(const std::string& ns, AlarmId alarm_id,
+                std::time_t now, std::time_t seconds);
+
+    // Plazo más cercano de todas las sesiones; false si no hay ninguna
+    bool nextDeadline(std::time_t& deadline) const;
+    std::vector<Expired> popExpired(std::time_t now);
+
+    bool isRinging(const std::string& ns, AlarmId alarm_id) const;
+    const Session* find(const std::string& ns, AlarmId alarm_id) const;
+    bool hasNamespace(const std::string& ns) const;
+    // La que empezó a sonar más recientemente; nullptr si ninguna suena
+    const Session* current() const;
+    size_t ringingCount() const;
+    bool empty() const { return sessions_.empty(); }
+    const std::vector<Session>& sessions() const { return sessions_; }
+
+    // Cambia cada vez que una sesión pasa a sonar: el audio se reinicia
+    uint64_t ringGeneration() const { return ring_generation_; }
+
+private:
+    Session* findMutable(const std::string& ns, AlarmId alarm_id);
+
+    // Pocas a la vez: un vector se recorre más rápido que un mapa
+    std::vector<Session> sessions_;
+    std::time_t ring_timeout_;
+    uint64_t ring_generation_ = 0;
+};
+
+#endif
@@ -0,0 +1,186 @@
+#include "Simulation.h"
+#include "AlarmManager.h"
+#include "AudioBackend.h"
+#include "../utils/Clock.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace {
+
+// Lotes de creación: como POST /api/alarms/batch
+const size_t CREATE_BATCH = 1000;
+
+double cpuSeconds() {
+    struct rusage usage;
+    ::getrusage(RUSAGE_SELF, &usage);
+    auto seconds = [](const struct timeval& tv) { return tv.tv_sec + tv.tv_usec / 1e6; };
+    return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+}
+
+std::string temporaryDirectory() {
+    const char* base = std::getenv("TMPDIR");
+    std::string pattern = std::string(base && *base ? base : "/tmp") + "/wake_simulate.XXXXXX";
+    if (::mkdtemp(&pattern[0]) == nullptr) {
+        throw std::runtime_error("No se pudo crear " + pattern);
+    }
+    return pattern;
+}
+
+void removeDirectory(const std::string& path) {
+    if (DIR* dir = ::opendir(path.c_str())) {
+        while (struct dirent* entry = ::readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name != "." && name != "..") ::unlink((path + "/" + name).c_str());
+        }
+        ::closedir(dir);
+    }
+    ::rmdir(path.c_str());
+}
+
+}
+
+bool Simulation::Options::parse(int argc, char** argv, Options& options, std::string& error) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--simulate") continue;
+        if (i + 1 >= argc || (arg != "--alarms" && arg != "--speed")) {
+            error = "Argumento no reconocido: " + arg;
+            return false;
+        }
+
+        char* end = nullptr;
+        const char* value = argv[++i];
+        if (arg == "--alarms") {
+            options.alarms = std::strtoull(value, &end, 10);
+        } else {
+            options.speed = std::strtod(value, &end);
+        }
+        if (end == value || *end != '\0' || options.speed < 0) {
+            error = "Valor inválido para " + arg + ": " + value;
+            return false;
+        }
+    }
+    if (options.alarms == 0) {
+        error = "--alarms debe ser mayor que 0";
+        return false;
+    }
+    return true;
+}
+
+Simulation::Report Simulation::run(const Options& options) {
+    Report report;
+    report.alarms = options.alarms;
+
+    // Un día de hoy en hora local, de 00:00 a 00:00 (23 o 25 h si cambia
+    // el horario)
+    std::time_t today = std::time(nullptr);
+    std::tm local;
+    localtime_r(&today, &local);
+    local.tm_hour = local.tm_min = local.tm_sec = 0;
+    local.tm_isdst = -1;
+    const std::time_t start = std::mktime(&local);
+    local.tm_mday++;
+    local.tm_isdst = -1;
+    const std::time_t end = std::mktime(&local);
+    report.simulated_seconds = static_cast<double>(end - start);
+
+    auto clock = std::make_shared<SimulatedClock>(std::chrono::system_clock::from_time_t(start),
+                                                  options.speed > 0 ? options.speed : 1.0,
+                                                  options.speed <= 0);
+    // Crear las alarmas no debe comerse el principio del día
+    clock->pause();
+
+    std::mutex drifts_mutex;
+    std::vector<double> drifts;
+    drifts.reserve(options.alarms);
+
+    const std::string dir = temporaryDirectory();
+    AlarmManager::Options manager_options;
+    manager_options.storage_path = dir + "/alarms";
+    manager_options.audio_backend = std::make_shared<NullAudioBackend>();
+    manager_options.wakelock.enabled = false;
+    manager_options.clock = clock;
+    manager_options.on_fired = [&](const std::string&, const Alarm& alarm, double drift) {
+        // Al acabar el día el reloj puede haber saltado ya a mañana
+        if (alarm.next_fire >= end) return;
+        std::lock_guard<std::mutex> lock(drifts_mutex);
+        drifts.push_back(drift);
+    };
+
+    double cpu_before = 0;
+    auto wall_before = std::chrono::steady_clock::now();
+    {
+        AlarmManager manager(manager_options);
+
+        // Repartidas por igual a lo largo del día
+        std::vector<AlarmOperation> ops;
+        ops.reserve(CREATE_BATCH);
+        for (size_t i = 0; i < options.alarms; i++) {
+            size_t minute_of_day = i * 24 * 60 / options.alarms;
+            AlarmOperation op;
+            op.type = AlarmOperation::Type::Create;
+            op.hour = static_cast<int>(minute_of_day / 60);
+            op.minute = static_cast<int>(minute_of_day % 60);
+            op.label = "Simulación";
+            ops.push_back(std::move(op));
+            if (ops.size() == CREATE_BATCH || i + 1 == options.alarms) {
+                manager.applyBatch(ops);
+                ops.clear();
+            }
+        }
+        manager.flush();
+
+        cpu_before = cpuSeconds();
+        wall_before = std::chrono::steady_clock::now();
+        clock->resume();
+        manager.start();
+        while (clock->time() < end) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        manager.stop();
+    }
+    report.cpu_seconds = cpuSeconds() - cpu_before;
+    report.wall_seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - wall_before).count();
+    removeDirectory(dir);
+
+    std::lock_guard<std::mutex> lock(drifts_mutex);
+    report.fired = drifts.size();
+    if (!drifts.empty()) {
+        std::sort(drifts.begin(), drifts.end());
+        double sum = 0;
+        for (double drift : drifts) sum += drift;
+        report.drift_mean = sum / static_cast<double>(drifts.size());
+        report.drift_p99 = drifts[(drifts.size() - 1) * 99 / 100];
+        report.drift_max = drifts.back();
+    }
+    return report;
+}
+
+std::string Simulation::format(const Report& report) {
+    char text[512];
+    std::snprintf(text, sizeof(text),
+                  "Simulación de %.1f h con %zu alarmas\n"
+                  "  disparos:  %llu de %zu\n"
+                  "  retraso:   media %.3f s, p99 %.3f s, máx %.3f s\n"
+                  "  CPU:       %.2f s (%.1f µs por disparo)\n"
+                  "  duración:  %.2f s reales (x%.0f)\n",
+                  report.simulated_seconds / 3600, report.alarms,
+                  static_cast<unsigned long long>(report.fired), report.alarms,
+                  report.drift_mean, report.drift_p99, report.drift_max,
+                  report.cpu_seconds,
+                  report.fired > 0 ? report.cpu_seconds * 1e6 / static_cast<double>(report.fired) : 0.0,
+                  report.wall_seconds,
+                  report.wall_seconds > 0 ? report.simulated_seconds / report.wall_seconds : 0.0);
+    return text;
+}
@@ -0,0 +1,38 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// wake_server --simulate: un día completo de alarmas con un SimulatedClock,
+// en un directorio temporal (nunca toca los datos reales) y sin audio ni
+// wake lock. Sirve para medir capacidad: cuántos disparos salen, con qué
+// retraso y cuánta CPU cuestan.
+class Simulation {
+public:
+    struct Options {
+        size_t alarms = 100000;
+        // Segundos simulados por segundo real; 0: saltar de evento en evento
+        double speed = 0;
+
+        // --alarms N --speed X (tras --simulate); false si algo no se entiende
+        static bool parse(int argc, char** argv, Options& options, std::string& error);
+    };
+
+    struct Report {
+        size_t alarms = 0;
+        uint64_t fired = 0;
+        double drift_mean = 0;   // segundos simulados
+        double drift_p99 = 0;
+        double drift_max = 0;
+        double cpu_seconds = 0;  // usuario + sistema de todo el proceso
+        double wall_seconds = 0;
+        double simulated_seconds = 0;
+    };
+
+    static Report run(const Options& options);
+    static std::string format(const Report& report);
+};
+
+#endif
@@ -1,58 +1,263 @@
 #include "WakeLockManager.h"
 #include "../utils/Logger.h"
+#include "../utils/Process.h"
 #include <cstdlib>
+#include <cstring>
+#include <cerrno>
 #include <fstream>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
 #include <unistd.h>
 
-WakeLockManager::WakeLockManager() : is_acquired_(false) {}
+WakeLockManager::Options WakeLockManager::Options::fromEnvironment() {
+    Options options;
+    if (const char* margin = std::getenv("WAKE_LOCK_MARGIN")) {
+        long seconds = std::strtol(margin, nullptr, 10);
+        if (seconds >= 0) options.margin = std::chrono::seconds(seconds);
+    }
+    if (const char* keep_alive = std::getenv("WAKE_KEEP_ALIVE_FILE")) {
+        options.keep_alive_file = std::string(keep_alive) == "1";
+    }
+    if (const char* fallback = std::getenv("WAKE_LOCK_REALTIME_FALLBACK")) {
+        options.realtime_fallback = std::string(fallback) == "1";
+    }
+    return options;
+}
+
+WakeLockManager::WakeLockManager() : WakeLockManager(Options()) {}
+
+WakeLockManager::WakeLockManager(Options options, std::shared_ptr<Clock> clock)
+    : options_(options), clock_(std::move(clock)), state_since_(clock_->steadyNow()) {}
 
 WakeLockManager::~WakeLockManager() {
+    stop();
+}
+
+void WakeLockManager::start() {
+    if (thread_.joinable() || !options_.enabled) return;
+
+    // CLOCK_REALTIME_ALARM despierta al dispositivo aunque esté suspendido,
+    // pero necesita CAP_WAKE_ALARM: sin ella se usa CLOCK_REALTIME
+    timer_fd_ = ::timerfd_create(CLOCK_REALTIME_ALARM, TFD_CLOEXEC | TFD_NONBLOCK);
+    alarm_clock_ = timer_fd_ >= 0;
+    if (!alarm_clock_) {
+        int error = errno;
+        timer_fd_ = ::timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC | TFD_NONBLOCK);
+
+        static std::once_flag warned;
+        std::call_once(warned, [this, error] {
+            Logger::warning(std::string("⚠️ Sin CLOCK_REALTIME_ALARM (") + std::strerror(error) +
+                            "): el temporizador no despierta al dispositivo suspendido; " +
+                            (options_.realtime_fallback
+                                 ? "el WakeLock se suelta entre alarmas igualmente (WAKE_LOCK_REALTIME_FALLBACK=1)"
+                                 : "el WakeLock se mantiene siempre"));
+        });
+    }
+    event_fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (timer_fd_ < 0 || event_fd_ < 0) {
+        Logger::error("❌ No se pudo crear timerfd/eventfd para el WakeLock");
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = true;
+        always_hold_ = !alarm_clock_ && !options_.realtime_fallback;
+    }
+    thread_ = std::thread(&WakeLockManager::run, this);
+    Logger::info(std::string("WakeLockManager iniciado (") +
+                 (alarm_clock_ ? "CLOCK_REALTIME_ALARM" : "CLOCK_REALTIME") + ")");
+}
+
+void WakeLockManager::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+        wake();
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (timer_fd_ >= 0) ::close(timer_fd_);
+        if (event_fd_ >= 0) ::close(event_fd_);
+        timer_fd_ = event_fd_ = -1;
+    }
+
     release();
 }
 
-bool WakeLockManager::acquire() {
-    if (is_acquired_) return true;
-    
-    // Método 1: Termux-wake-lock (requiere termux-api)
-    bool success = executeTermuxAPI("termux-wake-lock");
-    
-    // Método 2: Crear archivo de actividad continua
-    writeTouchFile();
-    
-    if (success) {
-        is_acquired_ = true;
-        last_refresh_ = std::chrono::steady_clock::now();
-        Logger::info("WakeLock adquirido");
+void WakeLockManager::setNextDue(std::time_t due) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (next_due_ == due) return;
+    next_due_ = due;
+    wake();
+}
+
+void WakeLockManager::setRinging(bool ringing) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (ringing_ == ringing) return;
+    ringing_ = ringing;
+    wake();
+}
+
+WakeLockManager::Stats WakeLockManager::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+
+    // Sumar el tramo en curso
+    double current = std::chrono::duration<double>(clock_->steadyNow() - state_since_).count();
+    if (is_acquired_) {
+        stats.held_seconds += current;
     } else {
-        Logger::warning("No se pudo adquirir WakeLock (termux-api no disponible)");
+        stats.released_seconds += current;
     }
-    
-    return true; // Continuar aunque falle
+    stats.held = is_acquired_;
+    stats.always_held = always_hold_;
+    return stats;
 }
 
-bool WakeLockManager::release() {
-    if (!is_acquired_) return true;
-    
-    executeTermuxAPI("termux-wake-unlock");
-    is_acquired_ = false;
-    
-    Logger::info("WakeLock liberado");
-    return true;
+// Con mutex_ tomado: así no se escribe en un eventfd ya cerrado
+void WakeLockManager::wake() {
+    if (event_fd_ < 0) return;
+    uint64_t one = 1;
+    ssize_t written = ::write(event_fd_, &one, sizeof(one));
+    (void)written;
 }
 
-void WakeLockManager::refresh() {
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - last_refresh_).count();
-    
-    if (elapsed > 25) {
+void WakeLockManager::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (running_) {
+        bool want = false;
+        std::time_t wake_at = planLocked(clock_->time(), want);
+        lock.unlock();
+
+        // termux-wake-lock se lanza fuera del mutex: setNextDue() se llama
+        // desde el hilo del planificador y no debe esperar a un proceso
+        if (want) {
+            acquire();
+            refreshKeepAlive();
+        } else {
+            release();
+        }
+        armTimer(wake_at);
+
+        struct pollfd fds[2] = {{timer_fd_, POLLIN, 0}, {event_fd_, POLLIN, 0}};
+        int ready = ::poll(fds, 2, -1);
+        if (ready < 0 && errno != EINTR) {
+            Logger::error("❌ poll() del WakeLock falló");
+            lock.lock();
+            break;
+        }
+
+        // Vaciar ambos descriptores; ECANCELED en el timerfd indica que
+        // el reloj se ha cambiado, y basta con volver a evaluar
+        uint64_t count;
+        if (fds[0].revents & POLLIN) {
+            ssize_t n = ::read(timer_fd_, &count, sizeof(count));
+            (void)n;
+        }
+        if (fds[1].revents & POLLIN) {
+            ssize_t n = ::read(event_fd_, &count, sizeof(count));
+            (void)n;
+        }
+
+        lock.lock();
+    }
+}
+
+// Decide si ahora toca tener el wake lock y cuándo volver a mirar
+// (-1: sólo cuando cambie algo)
+std::time_t WakeLockManager::planLocked(std::time_t now, bool& want) const {
+    const std::time_t margin = options_.margin.count();
+    const std::time_t hold_after = options_.hold_after.count();
+
+    bool in_window = next_due_ >= 0 && now >= next_due_ - margin && now < next_due_ + hold_after;
+    want = always_hold_ || ringing_ || in_window;
+
+    std::time_t wake_at = -1;
+    if (next_due_ >= 0) {
+        wake_at = in_window ? next_due_ + hold_after : next_due_ - margin;
+        if (wake_at <= now) wake_at = -1;
+    }
+
+    if (want && options_.keep_alive_file) {
+        std::time_t refresh_at = now + options_.keep_alive_interval.count();
+        if (wake_at < 0 || refresh_at < wake_at) wake_at = refresh_at;
+    }
+
+    return wake_at;
+}
+
+void WakeLockManager::refreshKeepAlive() {
+    if (!options_.keep_alive_file) return;
+
+    auto now = clock_->steadyNow();
+    if (last_refresh_ == std::chrono::steady_clock::time_point() ||
+        now - last_refresh_ >= options_.keep_alive_interval) {
         writeTouchFile();
         last_refresh_ = now;
     }
 }
 
-bool WakeLockManager::executeTermuxAPI(const std::string& command) {
-    int result = system(command.c_str());
-    return (result == 0);
+void WakeLockManager::armTimer(std::time_t at) {
+    struct itimerspec spec = {};
+    if (at >= 0) {
+        // `at` es del reloj de la aplicación; el timerfd va con el real
+        auto real = clock_->realTime(std::chrono::system_clock::from_time_t(at)).time_since_epoch();
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(real);
+        spec.it_value.tv_sec = static_cast<std::time_t>(seconds.count());
+        spec.it_value.tv_nsec = static_cast<long>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(real - seconds).count());
+    }
+    // it_value a cero desarma el temporizador
+    int flags = at >= 0 ? (TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET) : 0;
+    ::timerfd_settime(timer_fd_, flags, &spec, nullptr);
+}
+
+// acquire()/release() sólo se llaman desde el hilo del WakeLock (o tras
+// pararlo), así que is_acquired_ se lee sin mutex; se escribe con él
+// porque stats() lo consulta desde otros hilos
+void WakeLockManager::acquire() {
+    if (is_acquired_) return;
+
+    // Termux-wake-lock (requiere termux-api)
+    if (executeTermuxAPI("termux-wake-lock")) {
+        Logger::info("WakeLock adquirido");
+    } else {
+        Logger::warning("No se pudo adquirir WakeLock (termux-api no disponible)");
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = clock_->steadyNow();
+    stats_.released_seconds += std::chrono::duration<double>(now - state_since_).count();
+    state_since_ = now;
+    stats_.acquisitions++;
+    is_acquired_ = true;
+    last_refresh_ = std::chrono::steady_clock::time_point();
+}
+
+void WakeLockManager::release() {
+    if (!is_acquired_) return;
+
+    executeTermuxAPI("termux-wake-unlock");
+    Logger::info("WakeLock liberado");
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = clock_->steadyNow();
+    stats_.held_seconds += std::chrono::duration<double>(now - state_since_).count();
+    state_since_ = now;
+    is_acquired_ = false;
+}
+
+bool WakeLockManager::executeTermuxAPI(const char* tool) {
+    std::string executable = Process::findExecutable(tool);
+    if (executable.empty()) return false;
+    return Process::run({executable}, std::chrono::seconds(5)) == 0;
 }
 
 void WakeLockManager::writeTouchFile() {
@@ -62,7 +267,4 @@ void WakeLockManager::writeTouchFile() {
         touch_file << std::chrono::system_clock::now().time_since_epoch().count();
         touch_file.close();
     }
-    
-    // Generar salida stdout para evitar suspensión
-    std::cout << "\r" << std::flush;
-}
\ No newline at end of file
+}
@@ -3,22 +3,86 @@
 
 #include <string>
 #include <chrono>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+#include <memory>
+#include "../utils/Clock.h"
 
+// Mantiene el wake lock sólo cuando hace falta: desde `margin` antes de la
+// próxima alarma hasta poco después, y mientras una alarma está sonando.
+// Un hilo duerme en un timerfd con CLOCK_REALTIME_ALARM y se despierta por
+// eventfd cuando cambia la próxima alarma. Sin CLOCK_REALTIME_ALARM (falta
+// CAP_WAKE_ALARM, lo normal en Termux) nada despertaría al dispositivo
+// suspendido para tomar el lock a tiempo, así que se mantiene siempre.
 class WakeLockManager {
 public:
+    struct Options {
+        std::chrono::seconds margin{120};      // antelación respecto a la alarma
+        std::chrono::seconds hold_after{60};   // margen tras la hora de la alarma
+        bool keep_alive_file = false;          // reescribir ~/.keep_alive mientras se tiene
+        std::chrono::seconds keep_alive_interval{30};
+        // false: start() no hace nada (p.ej. en --simulate)
+        bool enabled = true;
+        // Soltar el lock entre alarmas aunque sólo haya CLOCK_REALTIME: sólo
+        // si otra cosa despierta al dispositivo antes de cada alarma
+        bool realtime_fallback = false;
+
+        // WAKE_LOCK_MARGIN=<s>, WAKE_KEEP_ALIVE_FILE=1,
+        // WAKE_LOCK_REALTIME_FALLBACK=1
+        static Options fromEnvironment();
+    };
+
+    struct Stats {
+        bool held = false;
+        bool always_held = false;  // sin CLOCK_REALTIME_ALARM ni realtime_fallback
+        uint64_t acquisitions = 0;
+        double held_seconds = 0;
+        double released_seconds = 0;
+    };
+
     WakeLockManager();
+    explicit WakeLockManager(Options options, std::shared_ptr<Clock> clock = Clock::system());
     ~WakeLockManager();
-    
-    bool acquire();
-    bool release();
-    void refresh();
-    
+
+    void start();
+    void stop();
+
+    // Hora de la próxima alarma; -1 si no hay ninguna
+    void setNextDue(std::time_t due);
+    void setRinging(bool ringing);
+
+    Stats stats() const;
+
 private:
-    bool executeTermuxAPI(const std::string& command);
+    void run();
+    void wake();
+    std::time_t planLocked(std::time_t now, bool& want) const;
+    void armTimer(std::time_t at);
+    void acquire();
+    void release();
+    void refreshKeepAlive();
+    bool executeTermuxAPI(const char* tool);
     void writeTouchFile();
-    
-    bool is_acquired_;
+
+    Options options_;
+    const std::shared_ptr<Clock> clock_;
+    int timer_fd_{-1};
+    int event_fd_{-1};
+    bool alarm_clock_{false};  // timerfd con CLOCK_REALTIME_ALARM
+    std::thread thread_;
+
+    mutable std::mutex mutex_;
+    bool running_{false};
+    bool always_hold_{false};
+    std::time_t next_due_{-1};
+    bool ringing_{false};
+
+    bool is_acquired_{false};
+    std::chrono::steady_clock::time_point state_since_;
     std::chrono::steady_clock::time_point last_refresh_;
+    Stats stats_;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,17 +1,38 @@
 #ifndef ALARM_H
 #define ALARM_H
 
-#include <string>
+#include <cstdint>
+#include <ctime>
+#include "AlarmId.h"
+#include "Recurrence.h"
+#include "../utils/Interned.h"
 
-struct Alarm {
-    std::string id;
-    int hour;
-    int minute;
-    std::string label;
-    bool enabled;
-    bool vibrate;
-    std::string sound_file;
-    bool triggered_today = false;
+// Parte "caliente" de una alarma: lo que miran el scheduler al disparar y
+// los filtros por hora/estado al paginar. 16 bytes.
+struct AlarmTiming {
+    // Próximo disparo según `repeat`, calculado al programarla; -1 si está
+    // desactivada o la regla ya no tiene más días. No se guarda en disco.
+    std::time_t next_fire = -1;
+    uint8_t hour = 0;
+    uint8_t minute = 0;
+    bool enabled = true;
+    bool vibrate = true;
 };
 
-#endif
\ No newline at end of file
+using InternedRecurrence = Interned<Recurrence, RecurrenceHash>;
+
+// Parte "fría": sólo hace falta al mostrarla, guardarla o hacerla sonar.
+// Los textos y la regla están compartidos entre alarmas iguales. 32 bytes.
+struct AlarmDetails {
+    AlarmId id;
+    InternedString label;
+    InternedString sound_file;
+    InternedRecurrence repeat;
+};
+
+// La alarma completa, tal como viaja entre la API, el almacenamiento y
+// las sesiones. AlarmShard guarda las dos partes por separado.
+struct Alarm : AlarmTiming, AlarmDetails {
+};
+
+#endif
@@ -0,0 +1,432 @@
+#include "AlarmCodec.h"
+#include "../utils/JsonWriter.h"
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+
+// Anidamiento máximo al saltar valores desconocidos
+const int MAX_DEPTH = 64;
+
+// Cursor sobre el texto JSON. Mismas reglas que nlohmann::json::parse:
+// números según la gramática de JSON, strings en UTF-8 válido y sin
+// caracteres de control sin escapar.
+class Reader {
+public:
+    explicit Reader(std::string_view text)
+        : p_(text.data()), end_(text.data() + text.size()) {}
+
+    // Salta espacios y consume `c` si es lo siguiente
+    bool consume(char c) {
+        skipSpace();
+        if (p_ == end_ || *p_ != c) return false;
+        p_++;
+        return true;
+    }
+
+    bool atEnd() {
+        skipSpace();
+        return p_ == end_;
+    }
+
+    char peek() {
+        skipSpace();
+        return p_ == end_ ? '\0' : *p_;
+    }
+
+    bool readString(std::string& out) {
+        out.clear();
+        if (!consume('"')) return false;
+
+        while (p_ != end_) {
+            // Tramo sin escapes: se copia de una vez
+            const char* start = p_;
+            while (p_ != end_ && *p_ != '"' && *p_ != '\\' &&
+                   static_cast<unsigned char>(*p_) >= 0x20) {
+                if (static_cast<unsigned char>(*p_) < 0x80) {
+                    p_++;
+                } else if (!skipUtf8()) {
+                    return false;
+                }
+            }
+            out.append(start, p_);
+            if (p_ == end_ || static_cast<unsigned char>(*p_) < 0x20) return false;
+
+            char c = *p_++;
+            if (c == '"') return true;
+            if (p_ == end_ || !readEscape(out)) return false;
+        }
+        return false;
+    }
+
+    // Sólo enteros: 7.0 o 7e0 no valen como hora
+    bool readInt(long long& value) {
+        skipSpace();
+        const char* start = p_;
+        bool integer;
+        if (!scanNumber(integer) || !integer || p_ - start > 18) return false;
+
+        const char* digit = start;
+        bool negative = (*digit == '-');
+        if (negative) digit++;
+        value = 0;
+        for (; digit != p_; digit++) value = value * 10 + (*digit - '0');
+        if (negative) value = -value;
+        return true;
+    }
+
+    bool readBool(bool& value) {
+        skipSpace();
+        if (literal("true")) {
+            value = true;
+            return true;
+        }
+        if (literal("false")) {
+            value = false;
+            return true;
+        }
+        return false;
+    }
+
+    bool skipValue(int depth = 0) {
+        if (depth > MAX_DEPTH) return false;
+
+        std::string ignored;
+        switch (peek()) {
+            case '"':
+                return readString(ignored);
+            case '{':
+                p_++;
+                if (consume('}')) return true;
+                do {
+                    if (!readString(ignored) || !consume(':') || !skipValue(depth + 1)) return false;
+                } while (consume(','));
+                return consume('}');
+            case '[':
+                p_++;
+                if (consume(']')) return true;
+                do {
+                    if (!skipValue(depth + 1)) return false;
+                } while (consume(','));
+                return consume(']');
+            case 't':
+                return literal("true");
+            case 'f':
+                return literal("false");
+            case 'n':
+                return literal("null");
+            default: {
+                bool integer;
+                return scanNumber(integer);
+            }
+        }
+    }
+
+    // Texto del siguiente valor, sin interpretarlo
+    bool captureValue(std::string_view& raw) {
+        skipSpace();
+        const char* start = p_;
+        if (!skipValue()) return false;
+        raw = std::string_view(start, static_cast<size_t>(p_ - start));
+        return true;
+    }
+
+private:
+    void skipSpace() {
+        while (p_ != end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t')) p_++;
+    }
+
+    bool literal(const char* word) {
+        const char* q = p_;
+        for (; *word; word++, q++) {
+            if (q == end_ || *q != *word) return false;
+        }
+        p_ = q;
+        return true;
+    }
+
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    // -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+    bool scanNumber(bool& integer) {
+        const char* q = p_;
+        integer = true;
+        if (q != end_ && *q == '-') q++;
+        if (q == end_ || !isDigit(*q)) return false;
+        if (*q == '0') {
+            q++;
+        } else {
+            while (q != end_ && isDigit(*q)) q++;
+        }
+        if (q != end_ && *q == '.') {
+            integer = false;
+            if (++q == end_ || !isDigit(*q)) return false;
+            while (q != end_ && isDigit(*q)) q++;
+        }
+        if (q != end_ && (*q == 'e' || *q == 'E')) {
+            integer = false;
+            if (++q != end_ && (*q == '+' || *q == '-')) q++;
+            if (q == end_ || !isDigit(*q)) return false;
+            while (q != end_ && isDigit(*q)) q++;
+        }
+        p_ = q;
+        return true;
+    }
+
+    // Una secuencia UTF-8 multibyte bien formada (sin sobrelargas ni
+    // surrogates), como exige nlohmann
+    bool skipUtf8() {
+        unsigned char c = static_cast<unsigned char>(*p_);
+        size_t length;
+        uint32_t min;
+        if (c >= 0xc2 && c <= 0xdf) {
+            length = 2; min = 0x80;
+        } else if (c >= 0xe0 && c <= 0xef) {
+            length = 3; min = 0x800;
+        } else if (c >= 0xf0 && c <= 0xf4) {
+            length = 4; min = 0x10000;
+        } else {
+            return false;
+        }
+        if (static_cast<size_t>(end_ - p_) < length) return false;
+
+        uint32_t code = c & (0xff >> (length + 1));
+        for (size_t i = 1; i < length; i++) {
+            unsigned char next = static_cast<unsigned char>(p_[i]);
+            if ((next & 0xc0) != 0x80) return false;
+            code = (code << 6) | (next & 0x3f);
+        }
+        if (code < min || code > 0x10ffff || (code >= 0xd800 && code <= 0xdfff)) return false;
+        p_ += length;
+        return true;
+    }
+
+    bool readHex4(uint32_t& value) {
+        if (end_ - p_ < 4) return false;
+        value = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = *p_++;
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= static_cast<uint32_t>(c - '0');
+            else if (c >= 'a' && c <= 'f') value |= static_cast<uint32_t>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') value |= static_cast<uint32_t>(c - 'A' + 10);
+            else return false;
+        }
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, uint32_t code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xc0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xe0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        } else {
+            out += static_cast<char>(0xf0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+        }
+    }
+
+    // Detrás de la barra invertida
+    bool readEscape(std::string& out) {
+        switch (*p_++) {
+            case '"':  out += '"'; return true;
+            case '\\': out += '\\'; return true;
+            case '/':  out += '/'; return true;
+            case 'b':  out += '\b'; return true;
+            case 'f':  out += '\f'; return true;
+            case 'n':  out += '\n'; return true;
+            case 'r':  out += '\r'; return true;
+            case 't':  out += '\t'; return true;
+            case 'u': {
+                uint32_t code;
+                if (!readHex4(code)) return false;
+                if (code >= 0xd800 && code <= 0xdbff) {
+                    // Par de surrogates: 🔔
+                    uint32_t low;
+                    if (end_ - p_ < 2 || p_[0] != '\\' || p_[1] != 'u') return false;
+                    p_ += 2;
+                    if (!readHex4(low) || low < 0xdc00 || low > 0xdfff) return false;
+                    code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                } else if (code >= 0xdc00 && code <= 0xdfff) {
+                    return false;
+                }
+                appendUtf8(out, code);
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    const char* p_;
+    const char* end_;
+};
+
+bool readField(Reader& in, const char* name, std::string& value, int, int, std::string& error) {
+    if (in.readString(value)) return true;
+    error = std::string(name) + " debe ser un texto";
+    return false;
+}
+
+bool readField(Reader& in, const char* name, int& value, int min, int max, std::string& error) {
+    long long number;
+    if (!in.readInt(number)) {
+        error = std::string(name) + " debe ser un entero";
+        return false;
+    }
+    if (number < min || number > max) {
+        error = std::string(name) + " debe estar entre " + std::to_string(min) +
+                " y " + std::to_string(max);
+        return false;
+    }
+    value = static_cast<int>(number);
+    return true;
+}
+
+bool readField(Reader& in, const char* name, bool& value, int, int, std::string& error) {
+    if (in.readBool(value)) return true;
+    error = std::string(name) + " debe ser true o false";
+    return false;
+}
+
+// La regla de repetición es un objeto anidado y poco frecuente: se recorta
+// su texto y lo valida Recurrence::fromJson
+bool readField(Reader& in, const char*, Recurrence& value, int, int, std::string& error) {
+    std::string_view raw;
+    if (!in.captureValue(raw)) {
+        error = "JSON inválido";
+        return false;
+    }
+    nlohmann::json json = nlohmann::json::parse(raw.begin(), raw.end(), nullptr, false);
+    return !json.is_discarded() && Recurrence::fromJson(json, value, error);
+}
+
+void appendValue(std::string& out, const AlarmId& value) {
+    out += '"';
+    value.appendTo(out);
+    out += '"';
+}
+
+void appendValue(std::string& out, const InternedString& value) {
+    appendJsonString(out, value.get());
+}
+
+void appendValue(std::string& out, int value) {
+    char buffer[16];
+    int length = std::snprintf(buffer, sizeof(buffer), "%d", value);
+    out.append(buffer, static_cast<size_t>(length));
+}
+
+void appendValue(std::string& out, bool value) {
+    appendJsonBool(out, value);
+}
+
+void appendValue(std::string& out, const InternedRecurrence& value) {
+    value->appendJson(out);
+}
+
+}
+
+bool AlarmCodec::parse(std::string_view json, AlarmFields& fields,
+                       std::string* op, std::string& error) {
+    Reader in(json);
+    if (!in.consume('{')) {
+        error = "Se esperaba un objeto JSON";
+        return false;
+    }
+
+    if (!in.consume('}')) {
+        std::string key;
+        do {
+            if (!in.readString(key) || !in.consume(':')) {
+                error = "JSON inválido";
+                return false;
+            }
+
+#define WAKE_ALARM_FIELD_PARSE(name, type, part, bit, min, max)              \
+            if (key == #name) {                                                    \
+                if (!readField(in, #name, fields.name.emplace(), min, max, error)) \
+                    return false;                                                  \
+                continue;                                                          \
+            }
+            WAKE_ALARM_FIELDS(WAKE_ALARM_FIELD_PARSE)
+#undef WAKE_ALARM_FIELD_PARSE
+
+            if (op && key == "op") {
+                if (!in.readString(*op)) {
+                    error = "op debe ser un texto";
+                    return false;
+                }
+            } else if (!in.skipValue()) {
+                error = "JSON inválido";
+                return false;
+            }
+        } while (in.consume(','));
+
+        if (!in.consume('}')) {
+            error = "JSON inválido";
+            return false;
+        }
+    }
+
+    if (!in.atEnd()) {
+        error = "JSON inválido";
+        return false;
+    }
+    return true;
+}
+
+bool AlarmCodec::toAlarm(AlarmFields&& fields, Alarm& alarm, std::string& error) {
+    if (!fields.id || !fields.hour || !fields.minute) {
+        error = "id, hour y minute son obligatorios";
+        return false;
+    }
+
+    alarm.id = AlarmId::fromString(*fields.id);
+    alarm.hour = static_cast<uint8_t>(*fields.hour);
+    alarm.minute = static_cast<uint8_t>(*fields.minute);
+    alarm.label = fields.label ? std::string_view(*fields.label) : std::string_view("Alarma");
+    alarm.enabled = fields.enabled.value_or(true);
+    alarm.vibrate = fields.vibrate.value_or(true);
+    alarm.sound_file = fields.sound_file ? std::string_view(*fields.sound_file) : std::string_view("default");
+    alarm.repeat = fields.repeat ? InternedRecurrence(*fields.repeat) : InternedRecurrence();
+    return true;
+}
+
+void AlarmCodec::toOperation(AlarmFields&& fields, AlarmOperation& op) {
+    if (fields.id) op.id = std::move(*fields.id);
+    op.hour = fields.hour;
+    op.minute = fields.minute;
+    op.label = std::move(fields.label);
+    op.enabled = fields.enabled;
+    op.vibrate = fields.vibrate;
+    op.sound_file = std::move(fields.sound_file);
+    op.repeat = std::move(fields.repeat);
+}
+
+void AlarmCodec::appendFields(std::string& out, const AlarmTiming& timing,
+                              const AlarmDetails& details, uint32_t fields, bool& first) {
+#define WAKE_ALARM_FIELD_APPEND(name, type, part, bit, min, max)    \
+    if (fields & (bit)) {                                           \
+        out += first ? "\"" #name "\":" : ",\"" #name "\":";        \
+        appendValue(out, part.name);                                \
+        first = false;                                              \
+    }
+    WAKE_ALARM_FIELDS(WAKE_ALARM_FIELD_APPEND)
+#undef WAKE_ALARM_FIELD_APPEND
+}
+
+void AlarmCodec::appendObject(std::string& out, const Alarm& alarm, uint32_t fields) {
+    bool first = true;
+    out += '{';
+    appendFields(out, alarm, fields, first);
+    out += '}';
+}
@@ -0,0 +1,77 @@
+#ifndef ALARM_CODEC_H
+#define ALARM_CODEC_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "Alarm.h"
+#include "AlarmOperation.h"
+#include "AlarmQuery.h"
+
+// Campos de Alarm tal como van en JSON (API y journal), en orden de
+// salida. De esta lista salen AlarmFields, el parser y el serializador:
+// un campo nuevo se añade sólo aquí (y en Alarm).
+//
+//   X(miembro, tipo, parte de Alarm, bit de AlarmQuery, mínimo, máximo)
+//
+// La parte (timing o details) dice en cuál de las dos mitades de Alarm
+// vive el campo, para serializar sin juntarlas.
+//
+// El rango sólo se comprueba en los enteros.
+#define WAKE_ALARM_FIELDS(X)                                                   \
+    X(id,         std::string, details, AlarmQuery::FIELD_ID,         0, 0)   \
+    X(hour,       int,         timing,  AlarmQuery::FIELD_HOUR,       0, 23)  \
+    X(minute,     int,         timing,  AlarmQuery::FIELD_MINUTE,     0, 59)  \
+    X(label,      std::string, details, AlarmQuery::FIELD_LABEL,      0, 0)   \
+    X(enabled,    bool,        timing,  AlarmQuery::FIELD_ENABLED,    0, 0)   \
+    X(vibrate,    bool,        timing,  AlarmQuery::FIELD_VIBRATE,    0, 0)   \
+    X(sound_file, std::string, details, AlarmQuery::FIELD_SOUND_FILE, 0, 0)   \
+    X(repeat,     Recurrence,  details, AlarmQuery::FIELD_REPEAT,     0, 0)
+
+// Campos presentes en un objeto JSON de alarma; los ausentes quedan vacíos
+struct AlarmFields {
+#define WAKE_ALARM_FIELD_MEMBER(name, type, part, bit, min, max) std::optional<type> name;
+    WAKE_ALARM_FIELDS(WAKE_ALARM_FIELD_MEMBER)
+#undef WAKE_ALARM_FIELD_MEMBER
+};
+
+// Lectura y escritura de alarmas en JSON sin pasar por nlohmann::json:
+// una pasada sobre el texto, sin DOM intermedio. El formato es el mismo
+// que el de nlohmann (ver JsonWriter.h), salvo el orden de las claves.
+class AlarmCodec {
+public:
+    // Bits de AlarmQuery de todos los campos de la lista
+#define WAKE_ALARM_FIELD_BIT(name, type, part, bit, min, max) | (bit)
+    static constexpr uint32_t FIELDS = 0 WAKE_ALARM_FIELDS(WAKE_ALARM_FIELD_BIT);
+#undef WAKE_ALARM_FIELD_BIT
+
+    // Lee un objeto {...} con campos de alarma. Las claves desconocidas se
+    // saltan; la clave "op" (journal y lotes) va a `op` si no es nullptr.
+    // false con `error` si el JSON está mal formado, un campo tiene otro
+    // tipo o un entero se sale de su rango.
+    static bool parse(std::string_view json, AlarmFields& fields,
+                      std::string* op, std::string& error);
+
+    // Alarma guardada: id, hour y minute obligatorios; el resto con los
+    // valores por defecto de siempre
+    static bool toAlarm(AlarmFields&& fields, Alarm& alarm, std::string& error);
+
+    // Pasa los campos a una operación create/update (los ausentes quedan
+    // sin valor, como espera AlarmShard)
+    static void toOperation(AlarmFields&& fields, AlarmOperation& op);
+
+    // Añade a `out` los campos de `fields` (bits de AlarmQuery) como
+    // "clave":valor separados por comas; `first` (aún no hay ningún campo
+    // escrito en el objeto) se actualiza
+    static void appendFields(std::string& out, const AlarmTiming& timing,
+                             const AlarmDetails& details, uint32_t fields, bool& first);
+    static void appendFields(std::string& out, const Alarm& alarm, uint32_t fields, bool& first) {
+        appendFields(out, alarm, alarm, fields, first);
+    }
+
+    // Objeto completo: {"id":...,"repeat":...}
+    static void appendObject(std::string& out, const Alarm& alarm, uint32_t fields);
+};
+
+#endif
@@ -0,0 +1,87 @@
+#include "AlarmId.h"
+#include "../utils/Hash.h"
+#include <atomic>
+#include <ctime>
+
+namespace {
+
+const uint64_t GENERATED_BIT = 1ULL << 63;
+const uint64_t HASHED_BIT = 1ULL << 62;
+const int COUNTER_BITS = 24;
+const char PREFIX[] = "alarm_";
+const size_t PREFIX_LENGTH = sizeof(PREFIX) - 1;
+const char HEX[] = "0123456789abcdef";
+
+// Último id generado u observado (sólo los del espacio de generate())
+std::atomic<uint64_t> last_generated{0};
+
+void raiseLast(uint64_t value) {
+    uint64_t last = last_generated.load(std::memory_order_relaxed);
+    while (value > last &&
+           !last_generated.compare_exchange_weak(last, value, std::memory_order_relaxed)) {
+    }
+}
+
+bool parseHex(std::string_view text, uint64_t& value) {
+    value = 0;
+    for (char c : text) {
+        value <<= 4;
+        if (c >= '0' && c <= '9') value |= static_cast<uint64_t>(c - '0');
+        else if (c >= 'a' && c <= 'f') value |= static_cast<uint64_t>(c - 'a' + 10);
+        else return false;
+    }
+    return true;
+}
+
+}
+
+AlarmId AlarmId::generate() {
+    // Con el reloj como base los ids siguen creciendo entre reinicios;
+    // el contador sólo desempata dentro del mismo segundo
+    uint64_t base = GENERATED_BIT |
+                    (static_cast<uint64_t>(std::time(nullptr)) << COUNTER_BITS);
+    uint64_t last = last_generated.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+        next = last >= base ? last + 1 : base;
+    } while (!last_generated.compare_exchange_weak(last, next, std::memory_order_relaxed));
+    return AlarmId(next);
+}
+
+void AlarmId::observe(AlarmId id) {
+    if (id.value_ & GENERATED_BIT) raiseLast(id.value_);
+}
+
+AlarmId AlarmId::fromString(std::string_view text) {
+    // Sólo minúsculas, como las escribe appendTo(): así cada id tiene un
+    // único texto
+    if (text.compare(0, PREFIX_LENGTH, PREFIX) == 0) {
+        std::string_view digits = text.substr(PREFIX_LENGTH);
+        uint64_t value;
+        if (digits.size() == 8 && parseHex(digits, value)) {
+            return AlarmId(value);
+        }
+        if (digits.size() == 16 && parseHex(digits, value) &&
+            (value & (GENERATED_BIT | HASHED_BIT))) {
+            return AlarmId(value);
+        }
+    }
+    uint64_t hash = fnv1a64(text.data(), text.size());
+    return AlarmId(HASHED_BIT | (hash & (HASHED_BIT - 1)));
+}
+
+std::string AlarmId::toString() const {
+    std::string out;
+    appendTo(out);
+    return out;
+}
+
+void AlarmId::appendTo(std::string& out) const {
+    char buffer[PREFIX_LENGTH + 16];
+    size_t digits = value_ >> 32 ? 16 : 8;
+    std::copy(PREFIX, PREFIX + PREFIX_LENGTH, buffer);
+    for (size_t i = 0; i < digits; i++) {
+        buffer[PREFIX_LENGTH + i] = HEX[(value_ >> (4 * (digits - 1 - i))) & 0xf];
+    }
+    out.append(buffer, PREFIX_LENGTH + digits);
+}
@@ -0,0 +1,50 @@
+#ifndef ALARM_ID_H
+#define ALARM_ID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+// Identificador de alarma de 64 bits. Sólo se convierte a texto en los
+// bordes (API, journal, logs):
+//
+//   alarm_1a2b3c4d           antiguo (8 hex aleatorios, < 2^32)
+//   alarm_8000067a1c000001   nuevo: bit 63 + segundos << 24 + contador
+//
+// Los nuevos se generan crecientes en el proceso, así que no colisionan
+// entre sí; generate() nunca devuelve uno menor que los vistos con
+// observe() al cargar. Un texto que no tiene ninguna de las dos formas
+// (ficheros editados a mano) se convierte con un hash en el espacio del
+// bit 62, siempre al mismo valor; desde entonces sale como
+// alarm_4... (16 dígitos), que vuelve a leerse como el mismo id.
+class AlarmId {
+public:
+    AlarmId() = default;
+    explicit AlarmId(uint64_t value) : value_(value) {}
+
+    static AlarmId generate();
+    // Tras cargar de disco: generate() seguirá por encima de este id
+    static void observe(AlarmId id);
+
+    static AlarmId fromString(std::string_view text);
+
+    uint64_t value() const { return value_; }
+    std::string toString() const;
+    // "alarm_..." sin comillas, sin reservar memoria aparte
+    void appendTo(std::string& out) const;
+
+    bool operator==(const AlarmId& other) const { return value_ == other.value_; }
+    bool operator!=(const AlarmId& other) const { return value_ != other.value_; }
+    bool operator<(const AlarmId& other) const { return value_ < other.value_; }
+
+private:
+    uint64_t value_ = 0;
+};
+
+struct AlarmIdHash {
+    size_t operator()(const AlarmId& id) const { return std::hash<uint64_t>()(id.value()); }
+};
+
+#endif
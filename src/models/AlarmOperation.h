@@ -0,0 +1,32 @@
+#ifndef ALARM_OPERATION_H
+#define ALARM_OPERATION_H
+
+#include <string>
+#include <optional>
+#include "Recurrence.h"
+
+// Una operación de POST /api/alarms/batch (o de updateAlarm)
+struct AlarmOperation {
+    enum class Type { Create, Delete, Toggle, Update };
+    
+    Type type = Type::Create;
+    std::string id;  // delete / toggle / update
+    
+    // create: los campos ausentes toman el valor por defecto
+    // update: sólo se cambian los campos presentes
+    std::optional<int> hour;
+    std::optional<int> minute;
+    std::optional<std::string> label;
+    std::optional<bool> enabled;
+    std::optional<bool> vibrate;
+    std::optional<std::string> sound_file;
+    std::optional<Recurrence> repeat;
+};
+
+struct AlarmOperationResult {
+    bool success = false;
+    std::string id;
+    std::string error;
+};
+
+#endif
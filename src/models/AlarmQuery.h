@@ -0,0 +1,75 @@
+#ifndef ALARM_QUERY_H
+#define ALARM_QUERY_H
+
+#include <string>
+#include <optional>
+#include <cstdint>
+#include <cstddef>
+
+// Filtros, paginación y proyección para GET /api/alarms con parámetros.
+// El orden de recorrido es por id, así que el cursor `after` es
+// simplemente el id de la última alarma recibida.
+struct AlarmQuery {
+    enum Field : uint32_t {
+        FIELD_ID         = 1 << 0,
+        FIELD_HOUR       = 1 << 1,
+        FIELD_MINUTE     = 1 << 2,
+        FIELD_LABEL      = 1 << 3,
+        FIELD_ENABLED    = 1 << 4,
+        FIELD_VIBRATE    = 1 << 5,
+        FIELD_SOUND_FILE = 1 << 6,
+        FIELD_RINGING    = 1 << 7,
+        FIELD_REPEAT     = 1 << 8,
+        FIELD_NEXT_FIRE  = 1 << 9,
+        ALL_FIELDS       = (1 << 10) - 1,
+    };
+    
+    size_t limit = SIZE_MAX;
+    std::string after;
+    std::optional<bool> enabled;
+    int hour_min = 0;   // rango inclusivo; si hour_min > hour_max da la
+    int hour_max = 23;  // vuelta a medianoche (p.ej. 22..5)
+    std::string label_prefix;
+    uint32_t fields = ALL_FIELDS;
+    
+    bool matchesHour(int hour) const {
+        return hour_min <= hour_max ? (hour >= hour_min && hour <= hour_max)
+                                    : (hour >= hour_min || hour <= hour_max);
+    }
+    
+    // "id,hour,minute" -> máscara; false si algún campo no existe.
+    // El id se incluye siempre porque es el cursor de paginación.
+    static bool parseFields(const std::string& list, uint32_t& mask) {
+        static const struct { const char* name; Field field; } NAMES[] = {
+            {"id", FIELD_ID}, {"hour", FIELD_HOUR}, {"minute", FIELD_MINUTE},
+            {"label", FIELD_LABEL}, {"enabled", FIELD_ENABLED},
+            {"vibrate", FIELD_VIBRATE}, {"sound_file", FIELD_SOUND_FILE},
+            {"ringing", FIELD_RINGING}, {"repeat", FIELD_REPEAT},
+            {"next_fire", FIELD_NEXT_FIRE},
+        };
+        
+        mask = FIELD_ID;
+        size_t pos = 0;
+        while (pos <= list.size()) {
+            size_t comma = list.find(',', pos);
+            if (comma == std::string::npos) comma = list.size();
+            std::string name = list.substr(pos, comma - pos);
+            
+            if (!name.empty()) {
+                bool known = false;
+                for (const auto& entry : NAMES) {
+                    if (name == entry.name) {
+                        mask |= entry.field;
+                        known = true;
+                        break;
+                    }
+                }
+                if (!known) return false;
+            }
+            pos = comma + 1;
+        }
+        return true;
+    }
+};
+
+#endif
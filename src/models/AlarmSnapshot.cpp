@@ -0,0 +1,222 @@
+#include "AlarmSnapshot.h"
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../utils/Hash.h"
+
+namespace {
+
+// Tabla de strings con deduplicación ("default", etiquetas repetidas...)
+class StringTableBuilder {
+public:
+    void add(const std::string& s, uint32_t& offset, uint32_t& length) {
+        auto it = offsets_.find(s);
+        if (it == offsets_.end()) {
+            it = offsets_.emplace(s, static_cast<uint32_t>(data_.size())).first;
+            data_ += s;
+        }
+        offset = it->second;
+        length = static_cast<uint32_t>(s.size());
+    }
+
+    const std::string& data() const { return data_; }
+
+private:
+    std::string data_;
+    std::unordered_map<std::string, uint32_t> offsets_;
+};
+
+}
+
+std::string AlarmSnapshot::encode(const std::vector<Alarm>& alarms) {
+    StringTableBuilder strings;
+    std::vector<Record> records(alarms.size());
+
+    for (size_t i = 0; i < alarms.size(); i++) {
+        const Alarm& alarm = alarms[i];
+        Record& record = records[i];
+        std::memset(&record, 0, sizeof(record));
+
+        record.id = alarm.id.value();
+        strings.add(alarm.label, record.label_offset, record.label_length);
+        strings.add(alarm.sound_file, record.sound_offset, record.sound_length);
+        strings.add(alarm.repeat->encode(), record.repeat_offset, record.repeat_length);
+        record.hour = alarm.hour;
+        record.minute = alarm.minute;
+        record.flags = (alarm.enabled ? FLAG_ENABLED : 0) |
+                       (alarm.vibrate ? FLAG_VIBRATE : 0);
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.header_size = sizeof(Header);
+    header.record_count = records.size();
+    header.record_size = sizeof(Record);
+    header.strings_offset = sizeof(Header) + records.size() * sizeof(Record);
+    header.strings_size = strings.data().size();
+
+    std::string out;
+    out.reserve(header.strings_offset + header.strings_size);
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+    out.append(strings.data());
+
+    uint64_t checksum = fnv1a64(out.data() + sizeof(Header), out.size() - sizeof(Header));
+    std::memcpy(&out[offsetof(Header, checksum)], &checksum, sizeof(checksum));
+
+    return out;
+}
+
+bool AlarmSnapshot::decode(const char* data, size_t size, std::vector<Alarm>& alarms,
+                           std::string& error) {
+    if (size < sizeof(Header)) {
+        error = "fichero truncado";
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        error = "magic inválido";
+        return false;
+    }
+    if (header.version < 1 || header.version > VERSION) {
+        error = "versión no soportada: " + std::to_string(header.version);
+        return false;
+    }
+    const size_t record_size = header.version == 1 ? sizeof(RecordV1) :
+                               header.version == 2 ? sizeof(RecordV2) : sizeof(Record);
+    if (header.header_size != sizeof(Header) || header.record_size != record_size) {
+        error = "tamaños de cabecera/registro inesperados";
+        return false;
+    }
+    if (header.record_count > (size - sizeof(Header)) / record_size ||
+        header.strings_offset != sizeof(Header) + header.record_count * record_size ||
+        header.strings_size != size - header.strings_offset) {
+        error = "tamaño de fichero inconsistente";
+        return false;
+    }
+    if (fnv1a64(data + sizeof(Header), size - sizeof(Header)) != header.checksum) {
+        error = "checksum incorrecto";
+        return false;
+    }
+
+    const char* records = data + sizeof(Header);
+    const char* strings = data + header.strings_offset;
+    auto in_table = [&header](uint32_t offset, uint32_t length) {
+        return static_cast<uint64_t>(offset) + length <= header.strings_size;
+    };
+
+    alarms.clear();
+    alarms.reserve(header.record_count);
+
+    for (uint64_t i = 0; i < header.record_count; i++) {
+        Record record;
+        uint32_t id_offset = 0, id_length = 0;
+        if (header.version == VERSION) {
+            std::memcpy(&record, records + i * record_size, record_size);
+        } else {
+            // Un registro v1 es el prefijo de uno v2; sin regla queda a cero
+            RecordV2 old;
+            std::memset(&old, 0, sizeof(old));
+            std::memcpy(&old, records + i * record_size, record_size);
+            id_offset = old.id_offset;
+            id_length = old.id_length;
+            record.id = 0;
+            record.label_offset = old.label_offset;
+            record.label_length = old.label_length;
+            record.sound_offset = old.sound_offset;
+            record.sound_length = old.sound_length;
+            record.hour = old.hour;
+            record.minute = old.minute;
+            record.flags = old.flags;
+            record.repeat_offset = old.repeat_offset;
+            record.repeat_length = old.repeat_length;
+        }
+
+        if (!in_table(id_offset, id_length) ||
+            !in_table(record.label_offset, record.label_length) ||
+            !in_table(record.sound_offset, record.sound_length) ||
+            !in_table(record.repeat_offset, record.repeat_length)) {
+            error = "registro " + std::to_string(i) + " fuera de la tabla de strings";
+            alarms.clear();
+            return false;
+        }
+
+        // Con el checksum bien pero valores imposibles (otra versión, un
+        // bug al escribir) el snapshot se rechaza igual que si no cuadrara
+        if (record.hour > 23 || record.minute > 59) {
+            error = "registro " + std::to_string(i) + ": hora inválida";
+            alarms.clear();
+            return false;
+        }
+
+        Recurrence repeat;
+        if (!Recurrence::decode(strings + record.repeat_offset, record.repeat_length, repeat)) {
+            error = "registro " + std::to_string(i) + ": regla de repetición inválida";
+            alarms.clear();
+            return false;
+        }
+
+        Alarm alarm;
+        alarm.id = header.version == VERSION
+            ? AlarmId(record.id)
+            : AlarmId::fromString(std::string_view(strings + id_offset, id_length));
+        alarm.label = std::string_view(strings + record.label_offset, record.label_length);
+        alarm.sound_file = std::string_view(strings + record.sound_offset, record.sound_length);
+        alarm.repeat = repeat;
+        alarm.hour = record.hour;
+        alarm.minute = record.minute;
+        alarm.enabled = (record.flags & FLAG_ENABLED) != 0;
+        alarm.vibrate = (record.flags & FLAG_VIBRATE) != 0;
+        alarms.push_back(std::move(alarm));
+    }
+
+    return true;
+}
+
+bool AlarmSnapshot::readFile(const std::string& path, std::vector<Alarm>& alarms,
+                             std::string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = std::strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        error = std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    if (size == 0) {
+        ::close(fd);
+        error = "fichero vacío";
+        return false;
+    }
+
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        error = std::strerror(errno);
+        return false;
+    }
+
+    // Se recorre de principio a fin una sola vez: pedir lectura anticipada
+    ::madvise(map, size, MADV_SEQUENTIAL);
+    ::madvise(map, size, MADV_WILLNEED);
+
+    bool ok = decode(static_cast<const char*>(map), size, alarms, error);
+    ::munmap(map, size);
+    return ok;
+}
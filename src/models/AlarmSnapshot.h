@@ -0,0 +1,100 @@
+#ifndef ALARM_SNAPSHOT_H
+#define ALARM_SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Alarm.h"
+
+// Formato binario del snapshot de alarmas (alarms.snap), pensado para
+// leerse con mmap sin parsear texto:
+//
+//   [Header 64 B][Record 40 B x record_count][tabla de strings]
+//
+// Los strings (label, sound_file y la regla de repetición codificada
+// con Recurrence::encode) se guardan una sola vez en la tabla y los
+// registros sólo llevan offset + longitud; el id va en el registro con
+// sus 64 bits. El checksum (FNV-1a 64) cubre todo lo que va detrás de la
+// cabecera. Enteros en orden nativo (little-endian en x86_64 y arm64).
+class AlarmSnapshot {
+public:
+    static constexpr char MAGIC[8] = {'W', 'A', 'K', 'E', 'S', 'N', 'A', 'P'};
+    static constexpr uint32_t VERSION = 3;
+    
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_size;
+        uint64_t record_count;
+        uint32_t record_size;
+        uint32_t reserved;
+        uint64_t strings_offset;
+        uint64_t strings_size;
+        uint64_t checksum;
+        uint8_t padding[8];
+    };
+    
+    struct Record {
+        uint64_t id;             // AlarmId::value()
+        uint32_t label_offset;
+        uint32_t label_length;
+        uint32_t sound_offset;
+        uint32_t sound_length;
+        uint8_t hour;
+        uint8_t minute;
+        uint8_t flags;
+        uint8_t reserved[5];
+        uint32_t repeat_offset;
+        uint32_t repeat_length;  // 0: diaria sin excepciones
+    };
+    
+    // Versiones 1 y 2, con el id como texto en la tabla; se siguen leyendo
+    struct RecordV2 {
+        uint32_t id_offset;
+        uint32_t id_length;
+        uint32_t label_offset;
+        uint32_t label_length;
+        uint32_t sound_offset;
+        uint32_t sound_length;
+        uint8_t hour;
+        uint8_t minute;
+        uint8_t flags;
+        uint8_t reserved[5];
+        uint32_t repeat_offset;
+        uint32_t repeat_length;
+    };
+    
+    // Versión 1, además sin regla de repetición
+    struct RecordV1 {
+        uint32_t id_offset;
+        uint32_t id_length;
+        uint32_t label_offset;
+        uint32_t label_length;
+        uint32_t sound_offset;
+        uint32_t sound_length;
+        uint8_t hour;
+        uint8_t minute;
+        uint8_t flags;
+        uint8_t reserved[5];
+    };
+    
+    enum Flags : uint8_t {
+        FLAG_ENABLED = 1 << 0,
+        FLAG_VIBRATE = 1 << 1,
+    };
+    
+    static std::string encode(const std::vector<Alarm>& alarms);
+    static bool decode(const char* data, size_t size, std::vector<Alarm>& alarms,
+                       std::string& error);
+    
+    // mmap + decode; false si no existe o no pasa la validación
+    static bool readFile(const std::string& path, std::vector<Alarm>& alarms,
+                         std::string& error);
+};
+
+static_assert(sizeof(AlarmSnapshot::Header) == 64, "Header del snapshot debe ocupar 64 bytes");
+static_assert(sizeof(AlarmSnapshot::Record) == 40, "Record del snapshot debe ocupar 40 bytes");
+static_assert(sizeof(AlarmSnapshot::RecordV2) == 40, "Record v2 del snapshot debe ocupar 40 bytes");
+static_assert(sizeof(AlarmSnapshot::RecordV1) == 32, "Record v1 del snapshot debe ocupar 32 bytes");
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef ALARM_STORAGE_H
+#define ALARM_STORAGE_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <sys/types.h>
+#include "Alarm.h"
+
+// Persistencia de alarmas en dos piezas:
+//   - snapshot (alarms.snap): lista completa en formato binario (ver
+//     AlarmSnapshot), se reescribe sólo al compactar (fichero temporal +
+//     fsync + rename, nunca queda a medio escribir)
+//   - journal (alarms.journal): una línea JSON por mutación, en modo
+//     append; el coste de un cambio no depende de cuántas alarmas haya
+// Al arrancar se carga el snapshot y se reproduce el journal encima. Si sólo
+// existe el alarms.json antiguo se importa una vez y se renombra a
+// alarms.json.migrated.
+// Los registros son idempotentes (put con la alarma completa / del por id),
+// así que reproducir de más nunca cambia el resultado.
+//
+// appendPut/appendDelete sólo encolan: un hilo escritor agrupa todo lo que
+// llegue en max_commit_delay en un único write + fdatasync (group commit)
+// y, cuando toca, compacta. Así los mutadores no esperan nunca al disco.
+// Si el commit falla el journal se recorta a como estaba, el lote vuelve a
+// la cola y se reintenta; flush() informa del fallo.
+class AlarmStorage {
+public:
+    using SnapshotProvider = std::function<std::vector<Alarm>()>;
+    
+    struct Stats {
+        uint64_t records = 0;   // registros escritos en el journal
+        uint64_t commits = 0;   // write + fdatasync realizados
+        uint64_t bytes = 0;     // bytes escritos (journal + snapshots)
+        uint64_t snapshots = 0;
+        uint64_t failed_commits = 0;
+    };
+    
+    // base_path sin extensión: "alarms" -> alarms.snap, alarms.journal...
+    explicit AlarmStorage(const std::string& base_path = "alarms",
+                          std::chrono::milliseconds max_commit_delay = std::chrono::milliseconds(50));
+    ~AlarmStorage();
+    
+    std::vector<Alarm> load();
+    
+    // Registros que deben ir juntos en el mismo commit (lote de la API)
+    class Batch {
+    public:
+        void put(const Alarm& alarm);
+        void erase(AlarmId id);
+        bool empty() const { return records_ == 0; }
+        
+    private:
+        friend class AlarmStorage;
+        std::string lines_;
+        size_t records_ = 0;
+    };
+    
+    void appendPut(const Alarm& alarm);
+    void appendDelete(AlarmId id);
+    void append(const Batch& batch);
+    
+    // Arranca el hilo escritor; `provider` devuelve el estado actual para
+    // compactar cuando el journal supera compact_threshold registros
+    void start(SnapshotProvider provider, size_t compact_threshold = 1000);
+    
+    // Vacía la cola y detiene el hilo escritor
+    void stop();
+    
+    // Barrera: vuelve cuando todo lo encolado hasta ahora está en disco
+    // (true) o cuando un commit de eso falla (false; se seguirá reintentando)
+    bool flush();
+    
+    Stats stats();
+
+private:
+    void enqueueRecords(const std::string& lines, size_t records);
+    void writerLoop();
+    bool commitBatch(const std::string& batch, size_t records);
+    void requeueLocked(std::string& batch, size_t records);
+    void compactLocked();
+    bool loadLegacyJson(std::vector<Alarm>& alarms);
+    bool writeSnapshot(const std::vector<Alarm>& alarms);
+    size_t replayJournal(const std::string& path, std::vector<Alarm>& alarms);
+    bool openJournal();
+    void closeJournal();
+    
+    std::string snapshot_path_;
+    std::string legacy_json_path_;
+    std::string journal_path_;
+    std::string old_journal_path_;
+    std::chrono::milliseconds max_commit_delay_;
+    
+    // Cola de registros pendientes (lado productor)
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::condition_variable flushed_cv_;
+    std::string pending_;
+    size_t pending_records_ = 0;
+    uint64_t enqueued_seq_ = 0;
+    uint64_t durable_seq_ = 0;
+    uint64_t failures_ = 0;   // commits fallidos: despiertan a flush()
+    size_t flush_waiters_ = 0;
+    bool writer_running_ = false;
+    std::thread writer_thread_;
+    
+    // Fichero de journal y compactación (lado escritor)
+    std::mutex journal_mutex_;
+    int journal_fd_ = -1;
+    // >= 0: un commit fallido dejó bytes de más desde aquí y no se
+    // pudieron recortar; no se escribe nada detrás hasta conseguirlo
+    off_t journal_torn_at_ = -1;
+    size_t journal_records_ = 0;
+    SnapshotProvider provider_;
+    size_t compact_threshold_ = 1000;
+    Stats stats_;
+};
+
+#endif
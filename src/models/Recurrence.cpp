@@ -0,0 +1,362 @@
+#include "Recurrence.h"
+#include "../utils/Hash.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const int32_t NO_DAY = INT32_MIN;
+
+// Límites para que una regla recibida por la API no sea arbitrariamente grande
+const size_t MAX_DATES = 366;
+const int MAX_EVERY_DAYS = 3650;
+// Bits de weekdays: domingo (0) ... sábado (6)
+const uint8_t ALL_WEEKDAYS = 0x7F;
+
+// Algoritmos de calendario civil (proléptico gregoriano) de H. Hinnant
+int32_t daysFromCivil(int y, int m, int d) {
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const int yoe = y - era * 400;
+    const int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+void civilFromDays(int32_t z, int& y, int& m, int& d) {
+    z += 719468;
+    const int era = (z >= 0 ? z : z - 146096) / 146097;
+    const int doe = z - era * 146097;
+    const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = yoe + era * 400 + (m <= 2);
+}
+
+// 0 = domingo (1970-01-01 fue jueves)
+int weekdayOf(int32_t day) {
+    return day >= -4 ? (day + 4) % 7 : (day + 5) % 7 + 6;
+}
+
+// mktime con tm_isdst = -1: en el salto de primavera la hora inexistente
+// se normaliza a la siguiente válida
+std::time_t localTime(int32_t day, int hour, int minute) {
+    std::tm local{};
+    int y, m, d;
+    civilFromDays(day, y, m, d);
+    local.tm_year = y - 1900;
+    local.tm_mon = m - 1;
+    local.tm_mday = d;
+    local.tm_hour = hour;
+    local.tm_min = minute;
+    local.tm_isdst = -1;
+    return std::mktime(&local);
+}
+
+template <typename T>
+void appendPod(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool readPod(const char*& data, const char* end, T& value) {
+    if (static_cast<size_t>(end - data) < sizeof(value)) return false;
+    std::memcpy(&value, data, sizeof(value));
+    data += sizeof(value);
+    return true;
+}
+
+bool parseDateList(const nlohmann::json& list, const char* name,
+                   std::vector<int32_t>& days, std::string& error) {
+    if (!list.is_array() || list.size() > MAX_DATES) {
+        error = std::string(name) + " debe ser una lista de fechas YYYY-MM-DD";
+        return false;
+    }
+    days.clear();
+    for (const auto& item : list) {
+        int32_t day;
+        if (!item.is_string() || !Recurrence::parseDate(item.get<std::string>(), day)) {
+            error = std::string(name) + " debe ser una lista de fechas YYYY-MM-DD";
+            return false;
+        }
+        days.push_back(day);
+    }
+    std::sort(days.begin(), days.end());
+    days.erase(std::unique(days.begin(), days.end()), days.end());
+    return true;
+}
+
+void appendDateList(std::string& out, const std::vector<int32_t>& days) {
+    out += '[';
+    for (size_t i = 0; i < days.size(); i++) {
+        if (i > 0) out += ',';
+        out += '"';
+        out += Recurrence::formatDate(days[i]);
+        out += '"';
+    }
+    out += ']';
+}
+
+const char* typeName(Recurrence::Type type) {
+    switch (type) {
+        case Recurrence::Type::Daily: return "daily";
+        case Recurrence::Type::Weekly: return "weekly";
+        case Recurrence::Type::Dates: return "dates";
+        case Recurrence::Type::Interval: return "interval";
+    }
+    return "daily";
+}
+
+}
+
+std::time_t Recurrence::nextFire(int hour, int minute, std::time_t from) const {
+    std::tm local{};
+    ::localtime_r(&from, &local);
+    int32_t day = daysFromCivil(local.tm_year + 1900, local.tm_mon + 1, local.tm_mday);
+
+    // Primer día >= day que cumple la regla (sin mirar excepciones)
+    auto firstDayFrom = [this](int32_t day) -> int32_t {
+        switch (type) {
+            case Type::Daily:
+                return day;
+            case Type::Weekly:
+                // Sin ningún día de 0 a 6 el bucle no terminaría
+                if ((weekdays & ALL_WEEKDAYS) == 0) return NO_DAY;
+                while (!(weekdays & (1 << weekdayOf(day)))) day++;
+                return day;
+            case Type::Dates: {
+                auto it = std::lower_bound(dates.begin(), dates.end(), day);
+                return it == dates.end() ? NO_DAY : *it;
+            }
+            case Type::Interval:
+                if (day <= start_day) return start_day;
+                return start_day + (day - start_day + every_days - 1) / every_days * every_days;
+        }
+        return NO_DAY;
+    };
+
+    // Cada vuelta descarta un día (excepción o minuto ya pasado hoy), así
+    // que el bucle está acotado por el número de excepciones
+    for (size_t attempt = 0; attempt < exceptions.size() + 2; attempt++) {
+        day = firstDayFrom(day);
+        if (day == NO_DAY) return -1;
+
+        if (!std::binary_search(exceptions.begin(), exceptions.end(), day)) {
+            std::time_t at = localTime(day, hour, minute);
+            if (at + 60 > from) return at;
+        }
+        day++;
+    }
+    return -1;
+}
+
+bool Recurrence::operator==(const Recurrence& other) const {
+    return type == other.type && weekdays == other.weekdays &&
+           every_days == other.every_days && start_day == other.start_day &&
+           dates == other.dates && exceptions == other.exceptions;
+}
+
+size_t RecurrenceHash::operator()(const Recurrence& rule) const {
+    uint8_t type = static_cast<uint8_t>(rule.type);
+    uint64_t hash = fnv1a64(&type, sizeof(type));
+    hash = fnv1a64(&rule.weekdays, sizeof(rule.weekdays), hash);
+    hash = fnv1a64(&rule.every_days, sizeof(rule.every_days), hash);
+    hash = fnv1a64(&rule.start_day, sizeof(rule.start_day), hash);
+    hash = fnv1a64(rule.dates.data(), rule.dates.size() * sizeof(int32_t), hash);
+    // Separador: dates y exceptions con los mismos días no deben chocar
+    uint32_t count = static_cast<uint32_t>(rule.dates.size());
+    hash = fnv1a64(&count, sizeof(count), hash);
+    hash = fnv1a64(rule.exceptions.data(), rule.exceptions.size() * sizeof(int32_t), hash);
+    return static_cast<size_t>(hash);
+}
+
+nlohmann::json Recurrence::toJson() const {
+    nlohmann::json result;
+    result["type"] = typeName(type);
+
+    if (type == Type::Weekly) {
+        result["weekdays"] = nlohmann::json::array();
+        for (int i = 0; i < 7; i++) {
+            if (weekdays & (1 << i)) result["weekdays"].push_back(i);
+        }
+    } else if (type == Type::Dates) {
+        result["dates"] = nlohmann::json::array();
+        for (int32_t day : dates) result["dates"].push_back(formatDate(day));
+    } else if (type == Type::Interval) {
+        result["every_days"] = every_days;
+        result["start"] = formatDate(start_day);
+    }
+
+    if (!exceptions.empty()) {
+        result["except"] = nlohmann::json::array();
+        for (int32_t day : exceptions) result["except"].push_back(formatDate(day));
+    }
+    return result;
+}
+
+void Recurrence::appendJson(std::string& out) const {
+    out += "{\"type\":\"";
+    out += typeName(type);
+    out += '"';
+
+    if (type == Type::Weekly) {
+        out += ",\"weekdays\":[";
+        bool first = true;
+        for (int i = 0; i < 7; i++) {
+            if (!(weekdays & (1 << i))) continue;
+            if (!first) out += ',';
+            out += static_cast<char>('0' + i);
+            first = false;
+        }
+        out += ']';
+    } else if (type == Type::Dates) {
+        out += ",\"dates\":";
+        appendDateList(out, dates);
+    } else if (type == Type::Interval) {
+        out += ",\"every_days\":";
+        out += std::to_string(every_days);
+        out += ",\"start\":\"";
+        out += formatDate(start_day);
+        out += '"';
+    }
+
+    if (!exceptions.empty()) {
+        out += ",\"except\":";
+        appendDateList(out, exceptions);
+    }
+    out += '}';
+}
+
+bool Recurrence::fromJson(const nlohmann::json& json, Recurrence& rule, std::string& error) {
+    if (!json.is_object() || !json.contains("type") || !json["type"].is_string()) {
+        error = "repeat debe ser un objeto con type";
+        return false;
+    }
+
+    Recurrence parsed;
+    const std::string type = json["type"];
+    if (type == "daily") {
+        parsed.type = Type::Daily;
+    } else if (type == "weekly") {
+        parsed.type = Type::Weekly;
+        const auto* days = json.contains("weekdays") ? &json["weekdays"] : nullptr;
+        if (!days || !days->is_array() || days->empty()) {
+            error = "weekdays debe ser una lista de días (0 = domingo ... 6 = sábado)";
+            return false;
+        }
+        for (const auto& day : *days) {
+            if (!day.is_number_integer() || day.get<int>() < 0 || day.get<int>() > 6) {
+                error = "weekdays debe ser una lista de días (0 = domingo ... 6 = sábado)";
+                return false;
+            }
+            parsed.weekdays |= static_cast<uint8_t>(1 << day.get<int>());
+        }
+    } else if (type == "dates") {
+        parsed.type = Type::Dates;
+        if (!json.contains("dates") || !parseDateList(json["dates"], "dates", parsed.dates, error)) {
+            if (error.empty()) error = "dates debe ser una lista de fechas YYYY-MM-DD";
+            return false;
+        }
+        if (parsed.dates.empty()) {
+            error = "dates no puede estar vacío";
+            return false;
+        }
+    } else if (type == "interval") {
+        parsed.type = Type::Interval;
+        if (!json.contains("every_days") || !json["every_days"].is_number_integer() ||
+            json["every_days"].get<int>() < 1 || json["every_days"].get<int>() > MAX_EVERY_DAYS) {
+            error = "every_days debe estar entre 1 y " + std::to_string(MAX_EVERY_DAYS);
+            return false;
+        }
+        parsed.every_days = static_cast<uint16_t>(json["every_days"].get<int>());
+        if (!json.contains("start") || !json["start"].is_string() ||
+            !parseDate(json["start"].get<std::string>(), parsed.start_day)) {
+            error = "start debe ser una fecha YYYY-MM-DD";
+            return false;
+        }
+    } else {
+        error = "type debe ser daily, weekly, dates o interval";
+        return false;
+    }
+
+    if (json.contains("except") && !parseDateList(json["except"], "except", parsed.exceptions, error)) {
+        return false;
+    }
+
+    rule = std::move(parsed);
+    return true;
+}
+
+std::string Recurrence::encode() const {
+    std::string out;
+    if (isDefault()) return out;
+
+    appendPod(out, static_cast<uint8_t>(type));
+    appendPod(out, weekdays);
+    appendPod(out, every_days);
+    appendPod(out, start_day);
+    appendPod(out, static_cast<uint32_t>(dates.size()));
+    appendPod(out, static_cast<uint32_t>(exceptions.size()));
+    for (int32_t day : dates) appendPod(out, day);
+    for (int32_t day : exceptions) appendPod(out, day);
+    return out;
+}
+
+bool Recurrence::decode(const char* data, size_t size, Recurrence& rule) {
+    rule = Recurrence();
+    if (size == 0) return true;
+
+    const char* end = data + size;
+    uint8_t type;
+    uint32_t date_count, exception_count;
+    if (!readPod(data, end, type) || type > static_cast<uint8_t>(Type::Interval) ||
+        !readPod(data, end, rule.weekdays) || !readPod(data, end, rule.every_days) ||
+        !readPod(data, end, rule.start_day) || !readPod(data, end, date_count) ||
+        !readPod(data, end, exception_count)) {
+        return false;
+    }
+    if (static_cast<uint64_t>(date_count) + exception_count !=
+        static_cast<uint64_t>(end - data) / sizeof(int32_t)) {
+        return false;
+    }
+    rule.type = static_cast<Type>(type);
+    // Como fromJson: sólo días 0-6 y, si es semanal, al menos uno
+    if ((rule.weekdays & ~ALL_WEEKDAYS) != 0 ||
+        (rule.type == Type::Weekly && rule.weekdays == 0)) {
+        return false;
+    }
+
+    rule.dates.resize(date_count);
+    for (auto& day : rule.dates) readPod(data, end, day);
+    rule.exceptions.resize(exception_count);
+    for (auto& day : rule.exceptions) readPod(data, end, day);
+    return data == end && rule.every_days > 0;
+}
+
+bool Recurrence::parseDate(const std::string& text, int32_t& day) {
+    int y, m, d;
+    char tail;
+    if (text.size() != 10 || text[4] != '-' || text[7] != '-' ||
+        std::sscanf(text.c_str(), "%4d-%2d-%2d%c", &y, &m, &d, &tail) != 3) {
+        return false;
+    }
+    if (y < 1970 || y > 9999 || m < 1 || m > 12 || d < 1 || d > 31) return false;
+
+    // 2026-02-30 no existe: al volver a convertir no coincide
+    day = daysFromCivil(y, m, d);
+    int cy, cm, cd;
+    civilFromDays(day, cy, cm, cd);
+    return cy == y && cm == m && cd == d;
+}
+
+std::string Recurrence::formatDate(int32_t day) {
+    int y, m, d;
+    civilFromDays(day, y, m, d);
+    // Cabe cualquier int: el compilador no sabe que m y d son de 2 cifras
+    char buffer[40];
+    std::snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d", y, m, d);
+    return buffer;
+}
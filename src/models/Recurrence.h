@@ -0,0 +1,61 @@
+#ifndef RECURRENCE_H
+#define RECURRENCE_H
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+// Regla de repetición de una alarma. Los días se guardan como número de
+// día civil (días desde 1970-01-01), sin zona horaria: la hora local sólo
+// entra al calcular nextFire(), con mktime, así que los cambios de horario
+// (DST) quedan bien.
+//
+// JSON: {"type": "daily"}
+//       {"type": "weekly", "weekdays": [1, 2, 3, 4, 5]}      (0 = domingo)
+//       {"type": "dates", "dates": ["2026-12-24"]}             (una o varias fechas)
+//       {"type": "interval", "every_days": 2, "start": "2026-10-17"}
+//       + opcional en todas: "except": ["2026-12-25"]
+struct Recurrence {
+    enum class Type : uint8_t { Daily = 0, Weekly, Dates, Interval };
+
+    Type type = Type::Daily;
+    uint8_t weekdays = 0;             // Weekly: bit 0 = domingo ... bit 6 = sábado
+    uint16_t every_days = 1;          // Interval
+    int32_t start_day = 0;            // Interval: primer día
+    std::vector<int32_t> dates;       // Dates: ordenadas, sin repetidos
+    std::vector<int32_t> exceptions;  // días que no suena, ordenados
+
+    // Sin más disparos cuando se agotan las fechas (se desactiva al sonar)
+    bool isOneShot() const { return type == Type::Dates; }
+    bool isDefault() const { return type == Type::Daily && exceptions.empty(); }
+
+    // Próximo instante (hora local) >= from en que toca hour:minute:00;
+    // si ese minuto está en curso respecto a `from` cuenta el de hoy.
+    // -1 si la regla ya no tiene más días.
+    std::time_t nextFire(int hour, int minute, std::time_t from) const;
+
+    bool operator==(const Recurrence& other) const;
+    bool operator!=(const Recurrence& other) const { return !(*this == other); }
+
+    nlohmann::json toJson() const;
+    // Mismo contenido que toJson(), escrito directamente en `out`
+    void appendJson(std::string& out) const;
+    static bool fromJson(const nlohmann::json& json, Recurrence& rule, std::string& error);
+
+    // Representación binaria compacta (snapshot); vacía para la regla por defecto
+    std::string encode() const;
+    static bool decode(const char* data, size_t size, Recurrence& rule);
+
+    // "YYYY-MM-DD" <-> día civil
+    static bool parseDate(const std::string& text, int32_t& day);
+    static std::string formatDate(int32_t day);
+};
+
+// Para compartir reglas iguales (Interned)
+struct RecurrenceHash {
+    size_t operator()(const Recurrence& rule) const;
+};
+
+#endif
@@ -0,0 +1,629 @@
+#include "ApiRoutes.h"
+#include <resources.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+#include <stdexcept>
+#include "../utils/Logger.h"
+#include "../utils/HttpUtils.h"
+#include "../utils/Metrics.h"
+#include "../utils/JsonWriter.h"
+#include "../models/AlarmCodec.h"
+
+using json = nlohmann::json;
+
+// Envía un recurso embebido. Las referencias versionadas (?v=<hash>,
+// generadas en compilación) se cachean sin revalidar; el resto se
+// revalida con la ETag. La variante gzip ya viene comprimida del build y
+// el cuerpo se escribe directamente desde los bytes embebidos, sin copiarlo.
+static void serveResource(const httplib::Request& req, httplib::Response& res,
+                          const Resources::Resource& resource) {
+    bool gzip = !resource.gzip_content.empty() &&
+                acceptsGzip(req.get_header_value("Accept-Encoding"));
+    std::string_view etag = gzip ? resource.gzip_etag : resource.etag;
+    std::string_view body = gzip ? resource.gzip_content : resource.content;
+    
+    res.set_header("ETag", std::string(etag));
+    res.set_header("Vary", "Accept-Encoding");
+    if (req.has_param("v") && req.get_param_value("v") == resource.version) {
+        res.set_header("Cache-Control", "public, max-age=31536000, immutable");
+    } else {
+        res.set_header("Cache-Control", "no-cache");
+    }
+    
+    if (etagMatches(req.get_header_value("If-None-Match"), etag)) {
+        res.status = 304;
+        return;
+    }
+    
+    if (gzip) {
+        res.set_header("Content-Encoding", "gzip");
+    }
+    res.set_content_provider(body.size(), std::string(resource.mime_type),
+        [body](size_t offset, size_t length, httplib::DataSink& sink) {
+            return sink.write(body.data() + offset, length);
+        });
+}
+
+// Envuelve un handler para contar peticiones y errores y medir su duración
+// por ruta. En las respuestas por trozos (SSE, listados filtrados) se mide
+// el handler, no el envío del cuerpo. Las métricas se resuelven una vez al
+// registrar la ruta: por petición sólo quedan los atómicos.
+template <typename Handler>
+static httplib::Server::Handler instrumented(const char* method, const char* route,
+                                             Handler handler) {
+    const std::string labels = std::string("method=\"") + method + "\",route=\"" + route + "\"";
+    Counter& requests = Metrics::counter("wake_http_requests_total",
+                                         "Peticiones HTTP atendidas", labels);
+    Counter& errors = Metrics::counter("wake_http_errors_total",
+                                       "Peticiones HTTP con estado >= 400", labels);
+    Histogram& duration = Metrics::histogram("wake_http_request_duration_seconds",
+                                             "Duración del handler HTTP", labels);
+    
+    return [handler, &requests, &errors, &duration](const httplib::Request& req,
+                                                    httplib::Response& res) {
+        auto started = std::chrono::steady_clock::now();
+        try {
+            handler(req, res);
+        } catch (...) {
+            // httplib responde 500
+            duration.observe(std::chrono::steady_clock::now() - started);
+            requests.inc();
+            errors.inc();
+            throw;
+        }
+        duration.observe(std::chrono::steady_clock::now() - started);
+        requests.inc();
+        if (res.status >= 400) errors.inc();
+    };
+}
+
+// Estado de /api/alarms/status y del evento inicial de /api/events: la
+// alarma que suena más recientemente (ringing/label/id, lo que usa la UI)
+// y todas las sesiones abiertas, de cualquier namespace ("ns" si no es el
+// de por defecto)
+static json ringStatusJson(const AlarmManager::RingStatus& status) {
+    json result;
+    result["ringing"] = status.ringing;
+    result["label"] = status.label;
+    result["id"] = status.id;
+    if (!status.ns.empty()) result["ns"] = status.ns;
+    
+    result["sessions"] = json::array();
+    for (const auto& session : status.sessions) {
+        json item;
+        item["id"] = session.alarm_id.toString();
+        if (!session.ns.empty()) item["ns"] = session.ns;
+        item["label"] = session.label.get();
+        item["state"] = (session.state == RingSessions::State::Ringing) ? "ringing" : "snoozed";
+        item["started"] = session.started;
+        item["until"] = session.deadline;
+        item["snoozes"] = session.snoozes;
+        result["sessions"].push_back(item);
+    }
+    return result;
+}
+
+// Convierte un elemento de POST /api/alarms/batch en una operación
+static bool parseOperation(const json& item, AlarmOperation& op, std::string& error) {
+    if (!item.is_object() || !item.contains("op") || !item["op"].is_string()) {
+        error = "Falta el campo op";
+        return false;
+    }
+    
+    const std::string type = item["op"];
+    if (type == "create") {
+        op.type = AlarmOperation::Type::Create;
+    } else if (type == "delete") {
+        op.type = AlarmOperation::Type::Delete;
+    } else if (type == "toggle") {
+        op.type = AlarmOperation::Type::Toggle;
+    } else if (type == "update") {
+        op.type = AlarmOperation::Type::Update;
+    } else {
+        error = "Operación desconocida: " + type;
+        return false;
+    }
+    
+    try {
+        if (op.type != AlarmOperation::Type::Create) {
+            op.id = item.at("id").get<std::string>();
+        }
+        if (item.contains("hour")) op.hour = item["hour"].get<int>();
+        if (item.contains("minute")) op.minute = item["minute"].get<int>();
+        if (item.contains("label")) op.label = item["label"].get<std::string>();
+        if (item.contains("enabled")) op.enabled = item["enabled"].get<bool>();
+        if (item.contains("vibrate")) op.vibrate = item["vibrate"].get<bool>();
+        if (item.contains("sound_file")) op.sound_file = item["sound_file"].get<std::string>();
+        if (item.contains("repeat")) {
+            Recurrence repeat;
+            if (!Recurrence::fromJson(item["repeat"], repeat, error)) return false;
+            op.repeat = std::move(repeat);
+        }
+    } catch (const std::exception& e) {
+        error = e.what();
+        return false;
+    }
+    
+    return true;
+}
+
+// Entero no negativo completo ("12abc" no vale)
+static bool parseNumber(const std::string& text, size_t max, size_t& value) {
+    if (text.empty() || text.size() > 19) return false;
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + static_cast<size_t>(c - '0');
+    }
+    return value <= max;
+}
+
+// Parámetros de GET /api/alarms: limit, after, enabled, hour_min,
+// hour_max, label_prefix y fields
+static const char* const QUERY_PARAMS[] = {
+    "limit", "after", "enabled", "hour_min", "hour_max", "label_prefix", "fields"
+};
+
+// Sólo estos parámetros llevan al listado por trozos: otros (p.ej. el
+// "?_=123" que añaden algunos clientes contra la caché) se ignoran y la
+// respuesta sigue siendo la lista completa con su ETag
+static bool hasQueryParams(const httplib::Request& req) {
+    for (const char* name : QUERY_PARAMS) {
+        if (req.has_param(name)) return true;
+    }
+    return false;
+}
+
+static bool parseQuery(const httplib::Request& req, AlarmQuery& query, std::string& error) {
+    size_t number = 0;
+    
+    if (req.has_param("limit")) {
+        if (!parseNumber(req.get_param_value("limit"), 100000, number) || number == 0) {
+            error = "limit debe estar entre 1 y 100000";
+            return false;
+        }
+        query.limit = number;
+    }
+    if (req.has_param("after")) {
+        query.after = req.get_param_value("after");
+    }
+    if (req.has_param("enabled")) {
+        const std::string value = req.get_param_value("enabled");
+        if (value != "true" && value != "false") {
+            error = "enabled debe ser true o false";
+            return false;
+        }
+        query.enabled = (value == "true");
+    }
+    if (req.has_param("hour_min")) {
+        if (!parseNumber(req.get_param_value("hour_min"), 23, number)) {
+            error = "hour_min debe estar entre 0 y 23";
+            return false;
+        }
+        query.hour_min = static_cast<int>(number);
+    }
+    if (req.has_param("hour_max")) {
+        if (!parseNumber(req.get_param_value("hour_max"), 23, number)) {
+            error = "hour_max debe estar entre 0 y 23";
+            return false;
+        }
+        query.hour_max = static_cast<int>(number);
+    }
+    if (req.has_param("label_prefix")) {
+        query.label_prefix = req.get_param_value("label_prefix");
+    }
+    if (req.has_param("fields")) {
+        if (!AlarmQuery::parseFields(req.get_param_value("fields"), query.fields)) {
+            error = "Campo desconocido en fields";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Namespace de la petición: "" en /api/alarms, :user en /api/u/:user/alarms.
+// Si :user no es válido responde 400 y devuelve false.
+static bool requestNamespace(const httplib::Request& req, httplib::Response& res, std::string& ns) {
+    auto it = req.path_params.find("user");
+    if (it == req.path_params.end()) {
+        ns.clear();
+        return true;
+    }
+    ns = it->second;
+    if (AlarmManager::isValidNamespace(ns)) return true;
+    
+    res.status = 400;
+    json error;
+    error["success"] = false;
+    error["error"] = "Namespace inválido";
+    res.set_content(error.dump(), "application/json");
+    return false;
+}
+
+// Rutas de alarmas bajo `base`: /api/alarms (namespace por defecto) o
+// /api/u/:user/alarms. Cada namespace tiene su propio shard en el manager,
+// así que las peticiones de un usuario no esperan a las de otro.
+static void registerAlarmRoutes(httplib::Server& svr, AlarmManager& alarmManager,
+                                const std::string& base) {
+    // API: Listar alarmas (copia pre-serializada + ETag para responder 304)
+    svr.Get(base, instrumented("GET", base.c_str(), [&alarmManager](const httplib::Request& req, httplib::Response& res) {
+        std::string ns;
+        if (!requestNamespace(req, res, ns)) return;
+        if (hasQueryParams(req)) {
+            // Con filtros o paginación: se escribe por trozos directamente
+            // desde las alarmas, sin construir la lista completa
+            AlarmQuery query;
+            std::string error;
+            if (!parseQuery(req, query, error)) {
+                res.status = 400;
+                json response;
+                response["success"] = false;
+                response["error"] = error;
+                res.set_content(response.dump(), "application/json");
+                return;
+            }
+            
+            struct StreamState {
+                AlarmQuery query;
+                std::string cursor;
+                size_t emitted = 0;
+                bool started = false;
+                bool finished = false;
+            };
+            auto state = std::make_shared<StreamState>();
+            state->cursor = query.after;
+            state->query = std::move(query);
+            
+            res.set_header("Cache-Control", "no-store");
+            res.set_chunked_content_provider("application/json",
+                [&alarmManager, state, ns](size_t, httplib::DataSink& sink) {
+                    const size_t chunk_records = 256;
+                    std::string chunk;
+                    
+                    if (!state->started) {
+                        chunk += '[';
+                        state->started = true;
+                    }
+                    
+                    // Con filtros selectivos una página puede salir vacía:
+                    // seguir recorriendo hasta tener algo que enviar
+                    const size_t emitted_before = state->emitted;
+                    while (!state->finished && state->emitted == emitted_before) {
+                        size_t remaining = state->query.limit - state->emitted;
+                        bool more = alarmManager.readAlarmPage(
+                            ns, state->query, state->cursor,
+                            std::min(remaining, chunk_records), chunk, state->emitted);
+                        state->finished = !more || state->emitted >= state->query.limit;
+                    }
+                    
+                    if (state->finished) {
+                        chunk += ']';
+                    }
+                    if (!sink.write(chunk.data(), chunk.size())) {
+                        return false;
+                    }
+                    if (state->finished) {
+                        sink.done();
+                    }
+                    return true;
+                });
+            return;
+        }
+        
+        auto list = alarmManager.getAlarmListSnapshot(ns);
+        res.set_header("ETag", list->etag);
+        res.set_header("Cache-Control", "no-cache");
+        
+        if (etagMatches(req.get_header_value("If-None-Match"), list->etag)) {
+            res.status = 304;
+            return;
+        }
+        res.set_content(list->json, "application/json");
+    }));
+
+    // API: Crear alarma
+    svr.Post(base, instrumented("POST", base.c_str(), [&alarmManager](const httplib::Request& req, httplib::Response& res) {
+        std::string ns;
+        if (!requestNamespace(req, res, ns)) return;
+        try {
+            // Parser específico del esquema de Alarm: sin DOM intermedio
+            AlarmFields fields;
+            std::string parse_error;
+            if (!AlarmCodec::parse(req.body, fields, nullptr, parse_error)) {
+                throw std::invalid_argument(parse_error);
+            }
+            if (!fields.hour || !fields.minute) {
+                throw std::invalid_argument("hour y minute son obligatorios");
+            }
+            AlarmOperation op;
+            AlarmCodec::toOperation(std::move(fields), op);
+            
+            std::string alarm_id = alarmManager.createAlarm(
+                ns,
+                *op.hour,
+                *op.minute,
+                op.label.value_or("Alarma"),
+                op.vibrate.value_or(true),
+                op.sound_file.value_or("default"),
+                op.repeat.value_or(Recurrence())
+            );
+            
+            std::string response = "{\"id\":";
+            appendJsonString(response, alarm_id);
+            response += ",\"success\":true}";
+            res.set_content(response, "application/json");
+        } catch (const std::exception& e) {
+            res.status = 400;
+            json error;
+            error["success"] = false;
+            error["error"] = e.what();
+            res.set_content(error.dump(), "application/json");
+        }
+    }));
+
+    // API: Lote de operaciones (create/delete/toggle/update) con un solo
+    // bloqueo y un solo commit a disco
+    svr.Post(base + "/batch", instrumented("POST", (base + "/batch").c_str(), [&alarmManager](const httplib::Request& req, httplib::Response& res) {
+        std::string ns;
+        if (!requestNamespace(req, res, ns)) return;
+        json body;
+        try {
+            body = json::parse(req.body);
+        } catch (const std::exception& e) {
+            res.status = 400;
+            json error;
+            error["success"] = false;
+            error["error"] = e.what();
+            res.set_content(error.dump(), "application/json");
+            return;
+        }
+        
+        json items = body.is_object() ? body.value("operations", json::array()) : std::move(body);
+        if (!items.is_array()) {
+            res.status = 400;
+            json error;
+            error["success"] = false;
+            error["error"] = "Se esperaba un array de operaciones";
+            res.set_content(error.dump(), "application/json");
+            return;
+        }
+        
+        // Las operaciones mal formadas no llegan al manager pero conservan
+        // su posición en la respuesta
+        std::vector<AlarmOperationResult> results(items.size());
+        std::vector<AlarmOperation> ops;
+        std::vector<size_t> positions;
+        ops.reserve(items.size());
+        positions.reserve(items.size());
+        
+        for (size_t i = 0; i < items.size(); i++) {
+            AlarmOperation op;
+            if (parseOperation(items[i], op, results[i].error)) {
+                ops.push_back(std::move(op));
+                positions.push_back(i);
+            }
+        }
+        
+        auto applied = alarmManager.applyBatch(ns, ops);
+        for (size_t i = 0; i < applied.size(); i++) {
+            results[positions[i]] = std::move(applied[i]);
+        }
+        
+        bool all_ok = true;
+        json response_results = json::array();
+        for (const auto& result : results) {
+            json item;
+            item["success"] = result.success;
+            if (!result.id.empty()) item["id"] = result.id;
+            if (!result.success) item["error"] = result.error;
+            response_results.push_back(item);
+            all_ok = all_ok && result.success;
+        }
+        
+        json response;
+        response["success"] = all_ok;
+        response["results"] = response_results;
+        res.set_content(response.dump(), "application/json");
+    }));
+
+    // API: Eliminar alarma
+    svr.Delete(base + "/:id", instrumented("DELETE", (base + "/:id").c_str(), [&alarmManager](const httplib::Request& req, httplib::Response& res) {
+        std::string ns;
+        if (!requestNamespace(req, res, ns)) return;
+        std::string id = req.path_params.at("id");
+        bool success = alarmManager.deleteAlarm(ns, id);
+        
+        json response;
+        response["success"] = success;
+        res.set_content(response.dump(), "application/json");
+    }));
+
+    // API: Activar/desactivar alarma
+    svr.Put(base + "/:id/toggle", instrumented("PUT", (base + "/:id/toggle").c_str(), [&alarmManager](const httplib::Request& req, httplib::Response& res) {
+        std::string ns;
+        if (!requestNamespace(req, res, ns)) return;
+        std::string id = req.path_params.at("id");
+        bool success = alarmManager.toggleAlarm(ns, id);
+        
+        json response;
+        response["success"] = success;
+        res.set_content(response.dump(), "application/json");
+    }));
+
+    // API: Detener todas las alarmas que suenan (o están pospuestas)
+    // del namespace
+    svr.Post(base + "/stop", instrumented("POST", (base + "/stop").c_str(), [&alarmManager](const httplib::Request& req, httplib::Response& res) {
+        std::string ns;
+        if (!requestNamespace(req, res, ns)) return;
+        // La ruta global detiene las de todos los namespaces
+        if (ns.empty()) {
+            alarmManager.stopCurrentAlarm();
+        } else {
+            alarmManager.stopAlarms(ns);
+        }
+        json response;
+        response["success"] = true;
+        res.set_content(response.dump(), "application/json");
+    }));
+
+    // API: Detener una alarma concreta
+    svr.Post(base + "/:id/stop", instrumented("POST", (base + "/:id/stop").c_str(), [&alarmManager](const httplib::Request& req, httplib::Response& res) {
+        std::string ns;
+        if (!requestNamespace(req, res, ns)) return;
+        std::string id = req.path_params.at("id");
+        
+        bool stopped = alarmManager.stopAlarm(ns, id);
+        
+        json response;
+        response["success"] = stopped;
+        if (!stopped) {
+            res.status = 409;
+            response["error"] = "La alarma no está sonando";
+        }
+        res.set_content(response.dump(), "application/json");
+    }));
+
+    // API: Posponer una alarma que suena ({"minutes": N} opcional)
+    svr.Post(base + "/:id/snooze", instrumented("POST", (base + "/:id/snooze").c_str(), [&alarmManager](const httplib::Request& req, httplib::Response& res) {
+        std::string ns;
+        if (!requestNamespace(req, res, ns)) return;
+        std::string id = req.path_params.at("id");
+        
+        json response;
+        int minutes = AlarmManager::DEFAULT_SNOOZE_MINUTES;
+        if (!req.body.empty()) {
+            json body = json::parse(req.body, nullptr, false);
+            if (body.is_discarded() || !body.is_object() ||
+                (body.contains("minutes") && !body["minutes"].is_number_integer())) {
+                res.status = 400;
+                response["success"] = false;
+                response["error"] = "JSON inválido";
+                res.set_content(response.dump(), "application/json");
+                return;
+            }
+            minutes = body.value("minutes", minutes);
+        }
+        if (minutes < 1 || minutes > 60) {
+            res.status = 400;
+            response["success"] = false;
+            response["error"] = "minutes debe estar entre 1 y 60";
+            res.set_content(response.dump(), "application/json");
+            return;
+        }
+        
+        bool snoozed = alarmManager.snoozeAlarm(ns, id, minutes);
+        response["success"] = snoozed;
+        if (!snoozed) {
+            res.status = 409;
+            response["error"] = "La alarma no está sonando";
+        } else {
+            response["minutes"] = minutes;
+        }
+        res.set_content(response.dump(), "application/json");
+    }));
+}
+
+void registerRoutes(httplib::Server& svr, AlarmManager& alarmManager) {
+    // Servir interfaz principal
+    svr.Get("/", instrumented("GET", "/", [](const httplib::Request& req, httplib::Response& res) {
+        // Resuelto en compilación
+        if constexpr (Resources::hasResource("/index.html")) {
+            constexpr const Resources::Resource* resource = Resources::getResource("/index.html");
+            serveResource(req, res, *resource);
+        } else {
+            res.status = 404;
+        }
+    }));
+
+    // API: Obtener estado de alarma sonando
+    svr.Get("/api/alarms/status", instrumented("GET", "/api/alarms/status", [&alarmManager](const httplib::Request&, httplib::Response& res) {
+        json response = ringStatusJson(alarmManager.getRingStatus());
+        
+        auto latency = alarmManager.getAudioLatency();
+        if (latency.samples > 0) {
+            response["audio_latency_ms"] = latency.last_ms;
+            response["audio_prearmed"] = latency.last_armed;
+        }
+        
+        auto wakelock = alarmManager.getWakeLockStats();
+        response["wakelock_held"] = wakelock.held;
+        response["wakelock_always_held"] = wakelock.always_held;
+        response["wakelock_held_seconds"] = wakelock.held_seconds;
+        response["wakelock_released_seconds"] = wakelock.released_seconds;
+        res.set_content(response.dump(), "application/json");
+    }));
+
+    // API: Stream de eventos (SSE) para que la UI no tenga que sondear
+    svr.Get("/api/events", instrumented("GET", "/api/events", [&alarmManager](const httplib::Request&, httplib::Response& res) {
+        auto subscription = alarmManager.events().subscribe();
+        if (!subscription) {
+            // Cada stream ocupa un hilo de httplib: no agotar el pool
+            res.status = 503;
+            res.set_header("Retry-After", "30");
+            json error;
+            error["success"] = false;
+            error["error"] = "Demasiados clientes suscritos";
+            res.set_content(error.dump(), "application/json");
+            return;
+        }
+        
+        res.set_header("Cache-Control", "no-cache");
+        res.set_chunked_content_provider("text/event-stream",
+            [&alarmManager, subscription](size_t offset, httplib::DataSink& sink) {
+                std::string chunk;
+                if (offset == 0) {
+                    // Estado inicial: una pestaña recién abierta ve la alarma que ya suena
+                    json status = ringStatusJson(alarmManager.getRingStatus());
+                    chunk = "retry: 3000\n" + EventHub::format(0, "status", status.dump());
+                } else if (!subscription->next(chunk, std::chrono::seconds(15))) {
+                    sink.done();
+                    return true;
+                }
+                return sink.write(chunk.data(), chunk.size());
+            },
+            [&alarmManager, subscription](bool) {
+                alarmManager.events().unsubscribe(subscription);
+            });
+    }));
+
+    // API: Alarmas del namespace por defecto y de cada usuario
+    registerAlarmRoutes(svr, alarmManager, "/api/alarms");
+    registerAlarmRoutes(svr, alarmManager, "/api/u/:user/alarms");
+
+    // Métricas en formato Prometheus
+    Metrics::gauge("wake_alarms", "Alarmas guardadas (namespace por defecto)", "",
+                   [&alarmManager] { return static_cast<double>(alarmManager.getAlarmCount()); });
+    Metrics::gauge("wake_namespaces_loaded", "Namespaces de alarmas cargados en memoria", "",
+                   [&alarmManager] { return static_cast<double>(alarmManager.getLoadedNamespaceCount()); });
+    Metrics::gauge("wake_sse_subscribers", "Clientes conectados a /api/events", "",
+                   [&alarmManager] { return static_cast<double>(alarmManager.events().subscriberCount()); });
+    Metrics::gauge("wake_alarm_ringing", "1 si hay una alarma sonando", "",
+                   [&alarmManager] { return alarmManager.isAlarmRinging() ? 1.0 : 0.0; });
+    Metrics::gauge("wake_audio_trigger_latency_seconds_max", "Peor latencia disparo→sonido", "",
+                   [&alarmManager] { return alarmManager.getAudioLatency().max_ms / 1000.0; });
+    Metrics::gauge("wake_wakelock_held", "1 si el wake lock está tomado", "",
+                   [&alarmManager] { return alarmManager.getWakeLockStats().held ? 1.0 : 0.0; });
+    Metrics::gauge("wake_wakelock_held_seconds", "Tiempo acumulado con wake lock", "",
+                   [&alarmManager] { return static_cast<double>(alarmManager.getWakeLockStats().held_seconds); });
+    Metrics::gauge("wake_log_lines_written", "Líneas de log escritas", "",
+                   [] { return static_cast<double>(Logger::stats().written); });
+    Metrics::gauge("wake_log_lines_dropped", "Líneas de log descartadas con la cola llena", "",
+                   [] { return static_cast<double>(Logger::stats().dropped); });
+    
+    svr.Get("/metrics", [](const httplib::Request&, httplib::Response& res) {
+        res.set_header("Cache-Control", "no-store");
+        res.set_content(Metrics::renderPrometheus(), "text/plain; version=0.0.4; charset=utf-8");
+    });
+
+    // Servir recursos estáticos
+    svr.Get(R"(/(.+))", instrumented("GET", "/*", [](const httplib::Request& req, httplib::Response& res) {
+        auto* resource = Resources::getResource(req.path);
+        if (resource) {
+            serveResource(req, res, *resource);
+        } else {
+            res.status = 404;
+        }
+    }));
+}
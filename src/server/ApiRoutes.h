@@ -0,0 +1,12 @@
+#ifndef API_ROUTES_H
+#define API_ROUTES_H
+
+#include "httplib.h"
+#include "../core/AlarmManager.h"
+
+// Registra en `svr` la API REST, /api/events, /metrics y los recursos
+// embebidos. Lo usan main y wake_loadgen, que levanta el servidor en el
+// propio proceso.
+void registerRoutes(httplib::Server& svr, AlarmManager& alarmManager);
+
+#endif
@@ -0,0 +1,81 @@
+#include "Clock.h"
+
+namespace {
+
+class SystemClock : public Clock {
+public:
+    TimePoint now() const override { return std::chrono::system_clock::now(); }
+    std::chrono::steady_clock::time_point steadyNow() const override {
+        return std::chrono::steady_clock::now();
+    }
+    TimePoint realTime(TimePoint at) const override { return at; }
+};
+
+}
+
+std::shared_ptr<Clock> Clock::system() {
+    static std::shared_ptr<Clock> clock = std::make_shared<SystemClock>();
+    return clock;
+}
+
+SimulatedClock::SimulatedClock(TimePoint start, double speed, bool jump)
+    : base_(start),
+      real_base_(std::chrono::steady_clock::now()),
+      steady_origin_(real_base_),
+      start_(start),
+      speed_(speed > 0 ? speed : 1.0),
+      jump_(jump) {
+}
+
+SimulatedClock::TimePoint SimulatedClock::nowLocked(std::chrono::steady_clock::time_point real) const {
+    if (paused_) return base_;
+    auto elapsed = std::chrono::duration<double>(real - real_base_) * speed_;
+    return base_ + std::chrono::duration_cast<std::chrono::system_clock::duration>(elapsed);
+}
+
+SimulatedClock::TimePoint SimulatedClock::now() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nowLocked(std::chrono::steady_clock::now());
+}
+
+std::chrono::steady_clock::time_point SimulatedClock::steadyNow() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return steady_origin_ + (nowLocked(std::chrono::steady_clock::now()) - start_);
+}
+
+SimulatedClock::TimePoint SimulatedClock::realTime(TimePoint at) const {
+    auto real_now = std::chrono::steady_clock::now();
+    TimePoint simulated_now;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        simulated_now = nowLocked(real_now);
+    }
+    // Lo que falta en tiempo simulado, a velocidad real
+    auto remaining = std::chrono::duration<double>(at - simulated_now) / speed_;
+    return std::chrono::system_clock::now() +
+           std::chrono::duration_cast<std::chrono::system_clock::duration>(remaining);
+}
+
+void SimulatedClock::idleUntil(TimePoint deadline) {
+    if (jump_) advanceTo(deadline);
+}
+
+void SimulatedClock::advanceTo(TimePoint at) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto real_now = std::chrono::steady_clock::now();
+    if (at <= nowLocked(real_now)) return;
+    base_ = at;
+    real_base_ = real_now;
+}
+
+void SimulatedClock::pause() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    base_ = nowLocked(std::chrono::steady_clock::now());
+    paused_ = true;
+}
+
+void SimulatedClock::resume() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    real_base_ = std::chrono::steady_clock::now();
+    paused_ = false;
+}
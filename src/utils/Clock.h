@@ -0,0 +1,73 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <mutex>
+
+// Hora que ven AlarmManager, AudioPlayer y WakeLockManager. En el servidor
+// es la del sistema; en --simulate y en pruebas un SimulatedClock permite
+// recorrer un día entero en segundos.
+//
+// Las esperas siguen siendo con wait_until/timerfd sobre el reloj real:
+// quien espera hasta un instante de este reloj lo convierte con realTime().
+class Clock {
+public:
+    using TimePoint = std::chrono::system_clock::time_point;
+
+    virtual ~Clock() = default;
+
+    // Hora de pared
+    virtual TimePoint now() const = 0;
+    // Para medir intervalos: en el reloj del sistema no retrocede aunque
+    // se cambie la hora
+    virtual std::chrono::steady_clock::time_point steadyNow() const = 0;
+    // Instante del reloj real (system_clock) en que este reloj llega a `at`
+    virtual TimePoint realTime(TimePoint at) const = 0;
+    // El scheduler no tiene nada que hacer hasta `deadline`: un reloj que
+    // salta de evento en evento avanza directamente hasta ahí
+    virtual void idleUntil(TimePoint deadline) { (void)deadline; }
+
+    std::time_t time() const { return std::chrono::system_clock::to_time_t(now()); }
+
+    // El del sistema, compartido por todos
+    static std::shared_ptr<Clock> system();
+};
+
+// Reloj que empieza en `start` y avanza `speed` segundos por cada segundo
+// real. Con `jump` además salta hasta el siguiente evento en cuanto el
+// scheduler se queda esperando, así que un día con alarmas repartidas se
+// recorre tan rápido como se procesan los disparos.
+class SimulatedClock : public Clock {
+public:
+    explicit SimulatedClock(TimePoint start, double speed = 1.0, bool jump = false);
+
+    TimePoint now() const override;
+    std::chrono::steady_clock::time_point steadyNow() const override;
+    TimePoint realTime(TimePoint at) const override;
+    void idleUntil(TimePoint deadline) override;
+
+    // Adelanta el reloj (nunca lo atrasa)
+    void advanceTo(TimePoint at);
+    // Parado no avanza solo (sí con saltos): p.ej. mientras se preparan
+    // los datos de la simulación
+    void pause();
+    void resume();
+
+private:
+    TimePoint nowLocked(std::chrono::steady_clock::time_point real) const;
+
+    mutable std::mutex mutex_;
+    // Hora simulada en el instante real `real_base_`
+    TimePoint base_;
+    std::chrono::steady_clock::time_point real_base_;
+    // steadyNow() parte de aquí: intervalos en tiempo simulado
+    std::chrono::steady_clock::time_point steady_origin_;
+    TimePoint start_;
+    const double speed_;
+    const bool jump_;
+    bool paused_ = false;
+};
+
+#endif
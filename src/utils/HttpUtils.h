@@ -0,0 +1,60 @@
+#ifndef HTTP_UTILS_H
+#define HTTP_UTILS_H
+
+#include <string>
+#include <string_view>
+#include <cctype>
+#include <cstdlib>
+
+// If-None-Match puede traer varias ETags separadas por comas, o "*"
+inline bool etagMatches(const std::string& if_none_match, std::string_view etag) {
+    if (if_none_match.empty()) return false;
+    if (if_none_match == "*") return true;
+
+    size_t pos = 0;
+    while (pos < if_none_match.size()) {
+        size_t comma = if_none_match.find(',', pos);
+        if (comma == std::string::npos) comma = if_none_match.size();
+
+        size_t begin = if_none_match.find_first_not_of(" \t", pos);
+        size_t end = if_none_match.find_last_not_of(" \t", comma - 1);
+        if (begin != std::string::npos && begin < comma && end >= begin &&
+            if_none_match.compare(begin, end - begin + 1, etag) == 0) {
+            return true;
+        }
+        pos = comma + 1;
+    }
+    return false;
+}
+
+// Accept-Encoding: "gzip, deflate, br" / "gzip;q=0.8" / "*"; q=0 la excluye
+inline bool acceptsGzip(const std::string& accept_encoding) {
+    size_t pos = 0;
+    while (pos < accept_encoding.size()) {
+        size_t comma = accept_encoding.find(',', pos);
+        if (comma == std::string::npos) comma = accept_encoding.size();
+
+        size_t begin = accept_encoding.find_first_not_of(" \t", pos);
+        if (begin != std::string::npos && begin < comma) {
+            size_t semicolon = accept_encoding.find(';', begin);
+            size_t name_end = (semicolon != std::string::npos && semicolon < comma) ? semicolon : comma;
+            while (name_end > begin && (accept_encoding[name_end - 1] == ' ' ||
+                                        accept_encoding[name_end - 1] == '\t')) {
+                name_end--;
+            }
+
+            std::string name = accept_encoding.substr(begin, name_end - begin);
+            for (char& c : name) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+
+            if (name == "gzip" || name == "x-gzip" || name == "*") {
+                size_t q = accept_encoding.find("q=", name_end);
+                if (q == std::string::npos || q >= comma) return true;
+                return std::strtod(accept_encoding.c_str() + q + 2, nullptr) > 0.0;
+            }
+        }
+        pos = comma + 1;
+    }
+    return false;
+}
+
+#endif
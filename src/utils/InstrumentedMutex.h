@@ -0,0 +1,62 @@
+#ifndef INSTRUMENTED_MUTEX_H
+#define INSTRUMENTED_MUTEX_H
+
+#include <mutex>
+#include <chrono>
+#include <string>
+#include "Metrics.h"
+
+// std::mutex que mide cuánto se espera para tomarlo y cuánto se retiene.
+// Cumple Lockable: sirve con lock_guard, unique_lock y
+// condition_variable_any (la espera de la condición no cuenta como retenido).
+class InstrumentedMutex {
+public:
+    explicit InstrumentedMutex(const std::string& name)
+        : wait_(Metrics::histogram("wake_mutex_wait_seconds",
+                                   "Tiempo esperando para tomar el mutex",
+                                   "mutex=\"" + name + "\"")),
+          hold_(Metrics::histogram("wake_mutex_hold_seconds",
+                                   "Tiempo con el mutex tomado",
+                                   "mutex=\"" + name + "\"")),
+          contended_(Metrics::counter("wake_mutex_contended_total",
+                                      "Veces que el mutex estaba ocupado al pedirlo",
+                                      "mutex=\"" + name + "\"")) {}
+
+    InstrumentedMutex(const InstrumentedMutex&) = delete;
+    InstrumentedMutex& operator=(const InstrumentedMutex&) = delete;
+
+    void lock() {
+        if (!mutex_.try_lock()) {
+            auto started = std::chrono::steady_clock::now();
+            mutex_.lock();
+            acquired_ = std::chrono::steady_clock::now();
+            contended_.inc();
+            wait_.observe(acquired_ - started);
+            return;
+        }
+        acquired_ = std::chrono::steady_clock::now();
+        wait_.observe(0.0);
+    }
+
+    bool try_lock() {
+        if (!mutex_.try_lock()) return false;
+        acquired_ = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    void unlock() {
+        // acquired_ sólo lo toca quien tiene el mutex
+        auto held = std::chrono::steady_clock::now() - acquired_;
+        mutex_.unlock();
+        hold_.observe(held);
+    }
+
+private:
+    std::mutex mutex_;
+    std::chrono::steady_clock::time_point acquired_;
+    Histogram& wait_;
+    Histogram& hold_;
+    Counter& contended_;
+};
+
+#endif
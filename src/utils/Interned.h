@@ -0,0 +1,161 @@
+#ifndef INTERNED_H
+#define INTERNED_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+// Valor inmutable compartido: todas las copias de un mismo valor apuntan
+// a la misma entrada de una tabla global con contador de referencias, así
+// que miles de alarmas con sound_file "default" o la misma regla de
+// repetición ocupan un puntero cada una. La entrada se libera con la
+// última referencia.
+//
+// Copiar y destruir no bloquea salvo al soltar la última referencia;
+// crear uno nuevo busca en la tabla, repartida en STRIPES partes con su
+// propio mutex para que los namespaces no se frenen entre sí.
+template <typename T, typename Hash = std::hash<T>>
+class Interned {
+public:
+    // El valor por defecto de T: no pasa por la tabla
+    Interned() : entry_(defaultEntry()) {}
+
+    // Cualquier cosa con la que se construya T (p.ej. un string_view para
+    // InternedString): si el valor ya está en la tabla no se construye
+    template <typename Key,
+              typename = std::enable_if_t<!std::is_same<std::decay_t<Key>, Interned>::value &&
+                                          std::is_constructible<T, const Key&>::value>>
+    Interned(const Key& key) : entry_(intern(key)) {}
+
+    Interned(const Interned& other) : entry_(other.entry_) { retain(entry_); }
+    Interned(Interned&& other) noexcept : entry_(other.entry_) { other.entry_ = defaultEntry(); }
+
+    Interned& operator=(const Interned& other) {
+        if (entry_ != other.entry_) {
+            retain(other.entry_);
+            release(entry_);
+            entry_ = other.entry_;
+        }
+        return *this;
+    }
+
+    Interned& operator=(Interned&& other) noexcept {
+        std::swap(entry_, other.entry_);
+        return *this;
+    }
+
+    ~Interned() { release(entry_); }
+
+    const T& get() const { return entry_->value; }
+    const T& operator*() const { return entry_->value; }
+    const T* operator->() const { return &entry_->value; }
+    operator const T&() const { return entry_->value; }
+
+    // Mismo valor, misma entrada
+    bool operator==(const Interned& other) const { return entry_ == other.entry_; }
+    bool operator!=(const Interned& other) const { return entry_ != other.entry_; }
+
+    // Valores distintos vivos en la tabla
+    static size_t poolSize() { return pool_size().load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t STRIPES = 16;
+
+    struct Entry {
+        T value;
+        size_t hash;
+        std::atomic<uint32_t> refs;
+    };
+
+    struct Stripe {
+        std::mutex mutex;
+        std::unordered_multimap<size_t, Entry*> entries;
+    };
+
+    static Entry* defaultEntry() {
+        // Nunca se libera: no cuenta referencias
+        static Entry* entry = new Entry{T(), 0, {1}};
+        return entry;
+    }
+
+    static Stripe* stripes() {
+        // Sin destructor: puede haber alarmas vivas al salir del proceso
+        static Stripe* table = new Stripe[STRIPES];
+        return table;
+    }
+
+    static std::atomic<size_t>& pool_size() {
+        static std::atomic<size_t> size{0};
+        return size;
+    }
+
+    template <typename Key>
+    static Entry* intern(const Key& key) {
+        // Así un valor igual al por defecto también compara igual
+        if (defaultEntry()->value == key) return defaultEntry();
+
+        size_t hash = Hash()(key);
+        Stripe& stripe = stripes()[hash % STRIPES];
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+
+        auto range = stripe.entries.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second->value == key) {
+                it->second->refs.fetch_add(1, std::memory_order_relaxed);
+                return it->second;
+            }
+        }
+        Entry* entry = new Entry{T(key), hash, {1}};
+        stripe.entries.emplace(hash, entry);
+        pool_size().fetch_add(1, std::memory_order_relaxed);
+        return entry;
+    }
+
+    static void retain(Entry* entry) {
+        if (entry != defaultEntry()) entry->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void release(Entry* entry) {
+        if (entry == defaultEntry()) return;
+
+        // Fuera de la tabla sólo se baja mientras queden más referencias:
+        // el paso a cero se hace con el mutex, para que intern() no pueda
+        // revivir una entrada que se está borrando
+        uint32_t refs = entry->refs.load(std::memory_order_relaxed);
+        while (refs > 1) {
+            if (entry->refs.compare_exchange_weak(refs, refs - 1, std::memory_order_acq_rel)) return;
+        }
+
+        Stripe& stripe = stripes()[entry->hash % STRIPES];
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        if (entry->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+        auto range = stripe.entries.equal_range(entry->hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == entry) {
+                stripe.entries.erase(it);
+                break;
+            }
+        }
+        pool_size().fetch_sub(1, std::memory_order_relaxed);
+        delete entry;
+    }
+
+    Entry* entry_;
+};
+
+// Para buscar strings por string_view sin construir uno: std::hash de
+// string y de string_view dan lo mismo para el mismo texto
+struct InternedStringHash {
+    size_t operator()(std::string_view text) const { return std::hash<std::string_view>()(text); }
+};
+
+using InternedString = Interned<std::string, InternedStringHash>;
+
+#endif
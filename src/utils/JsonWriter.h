@@ -0,0 +1,38 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <string>
+#include <cstdio>
+
+// Escritura directa de JSON en un buffer, sin construir un DOM intermedio.
+// Mismo criterio que nlohmann::json::dump(): UTF-8 tal cual, sólo se
+// escapan comillas, barra invertida y caracteres de control.
+inline void appendJsonString(std::string& out, const std::string& value) {
+    out += '"';
+    for (char c : value) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[7];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+inline void appendJsonBool(std::string& out, bool value) {
+    out += value ? "true" : "false";
+}
+
+#endif
@@ -0,0 +1,395 @@
+#include "Logger.h"
+#include <atomic>
+#include <condition_variable>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t QUEUE_CAPACITY = 2048;  // potencia de 2
+const size_t RECORD_SIZE = 512;      // línea ya formateada, se trunca si no cabe
+const size_t MAX_BATCH_BYTES = 64 * 1024;
+
+const char* levelName(Logger::Level level) {
+    switch (level) {
+        case Logger::Level::Debug: return "DEBUG";
+        case Logger::Level::Info: return "INFO";
+        case Logger::Level::Warning: return "WARN";
+        case Logger::Level::Error: return "ERROR";
+    }
+    return "INFO";
+}
+
+// Cola acotada de Vyukov: cada celda lleva un número de secuencia que dice
+// si está libre para el productor de esa vuelta o lista para el consumidor.
+// Varios productores compiten con un CAS sobre enqueue_pos_; hay un único
+// consumidor (el hilo escritor), que no necesita atómicos para su posición.
+class RingBuffer {
+public:
+    RingBuffer() : cells_(new Cell[QUEUE_CAPACITY]) {
+        for (size_t i = 0; i < QUEUE_CAPACITY; i++) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool tryPush(const char* data, size_t length) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells_[pos & (QUEUE_CAPACITY - 1)];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // llena
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->length = static_cast<uint16_t>(length);
+        std::memcpy(cell->text, data, length);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Sólo desde el hilo escritor
+    bool tryPop(std::string& out) {
+        Cell* cell = &cells_[dequeue_pos_ & (QUEUE_CAPACITY - 1)];
+        if (cell->sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) {
+            return false;
+        }
+        out.append(cell->text, cell->length);
+        cell->sequence.store(dequeue_pos_ + QUEUE_CAPACITY, std::memory_order_release);
+        dequeue_pos_++;
+        return true;
+    }
+
+    bool empty() const {
+        const Cell* cell = &cells_[dequeue_pos_ & (QUEUE_CAPACITY - 1)];
+        return cell->sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1;
+    }
+
+    static const size_t MAX_LENGTH = RECORD_SIZE - sizeof(std::atomic<size_t>) - sizeof(uint16_t);
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        uint16_t length;
+        char text[MAX_LENGTH];
+    };
+
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) size_t dequeue_pos_ = 0;
+    std::unique_ptr<Cell[]> cells_;
+};
+
+struct FileSink {
+    std::string path;
+    size_t max_bytes;
+    int max_files;
+    int fd = -1;
+    size_t size = 0;
+
+    bool open() {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+        struct stat st;
+        size = (::fstat(fd, &st) == 0) ? static_cast<size_t>(st.st_size) : 0;
+        return true;
+    }
+
+    void rotate() {
+        ::close(fd);
+        for (int i = max_files - 1; i >= 1; i--) {
+            std::string from = path + "." + std::to_string(i);
+            std::string to = path + "." + std::to_string(i + 1);
+            ::rename(from.c_str(), to.c_str());
+        }
+        if (max_files > 0) {
+            ::rename(path.c_str(), (path + ".1").c_str());
+        } else {
+            ::unlink(path.c_str());
+        }
+        open();
+    }
+};
+
+void writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+// "[HH:MM:SS] " del segundo actual; localtime_r sólo cuando cambia el
+// segundo, y por hilo, así que no hay estado compartido
+const char* timestampPrefix() {
+    thread_local std::time_t cached_second = -1;
+    thread_local char cached[16];
+
+    std::time_t now = std::time(nullptr);
+    if (now != cached_second) {
+        struct tm local;
+        localtime_r(&now, &local);
+        std::snprintf(cached, sizeof(cached), "[%02d:%02d:%02d] ",
+                      local.tm_hour, local.tm_min, local.tm_sec);
+        cached_second = now;
+    }
+    return cached;
+}
+
+class Backend {
+public:
+    // Nunca se destruye: se puede registrar incluso durante la salida
+    static Backend& instance() {
+        static Backend* backend = new Backend();
+        return *backend;
+    }
+
+    void log(Logger::Level level, const std::string& message) {
+        if (static_cast<int>(level) < level_.load(std::memory_order_relaxed)) return;
+
+        char line[RingBuffer::MAX_LENGTH];
+        int prefix = std::snprintf(line, sizeof(line), "%s[%s] ", timestampPrefix(), levelName(level));
+        size_t length = static_cast<size_t>(prefix);
+        size_t room = sizeof(line) - length - 1;
+        if (message.size() <= room) {
+            std::memcpy(line + length, message.data(), message.size());
+            length += message.size();
+        } else {
+            std::memcpy(line + length, message.data(), room - 3);
+            std::memcpy(line + length + room - 3, "...", 3);
+            length += room;
+        }
+        line[length++] = '\n';
+
+        if (!running_.load(std::memory_order_acquire)) {
+            // Sin hilo escritor (o ya parado en la salida): directo
+            std::lock_guard<std::mutex> lock(sinks_mutex_);
+            writeLocked(line, length);
+            return;
+        }
+
+        if (!queue_.tryPush(line, length)) {
+            // Cola llena: los avisos y errores esperan un poco a que el
+            // escritor haga sitio; el resto se descarta sin esperar
+            bool pushed = false;
+            if (level >= Logger::Level::Warning) {
+                for (int attempt = 0; attempt < 64 && !pushed; attempt++) {
+                    std::this_thread::yield();
+                    pushed = queue_.tryPush(line, length);
+                }
+            }
+            if (!pushed) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        enqueued_.fetch_add(1, std::memory_order_release);
+
+        // Sólo se avisa si el escritor está dormido; si el aviso se pierde
+        // en la carrera, el escritor se despierta solo al poco
+        if (writer_idle_.load(std::memory_order_acquire)) {
+            wake_cv_.notify_one();
+        }
+    }
+
+    void setLevel(Logger::Level level) { level_.store(static_cast<int>(level)); }
+    Logger::Level level() const { return static_cast<Logger::Level>(level_.load()); }
+    void setConsole(bool enabled) { console_.store(enabled); }
+
+    bool addFileSink(const std::string& path, size_t max_bytes, int max_files) {
+        FileSink sink{path, max_bytes, max_files};
+        if (!sink.open()) return false;
+        std::lock_guard<std::mutex> lock(sinks_mutex_);
+        sinks_.push_back(sink);
+        return true;
+    }
+
+    void flush() {
+        if (!running_.load(std::memory_order_acquire)) return;
+
+        uint64_t target = enqueued_.load(std::memory_order_acquire);
+        wake_cv_.notify_one();
+
+        std::unique_lock<std::mutex> lock(flush_mutex_);
+        while (written_.load(std::memory_order_acquire) < target &&
+               running_.load(std::memory_order_acquire)) {
+            flush_cv_.wait_for(lock, std::chrono::milliseconds(50));
+        }
+    }
+
+    Logger::Stats stats() const {
+        Logger::Stats stats;
+        stats.written = written_.load(std::memory_order_relaxed);
+        stats.dropped = dropped_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    Backend() {
+        if (const char* level = std::getenv("WAKE_LOG_LEVEL")) {
+            if (std::strcmp(level, "debug") == 0) level_ = static_cast<int>(Logger::Level::Debug);
+            else if (std::strcmp(level, "warning") == 0) level_ = static_cast<int>(Logger::Level::Warning);
+            else if (std::strcmp(level, "error") == 0) level_ = static_cast<int>(Logger::Level::Error);
+        }
+        if (const char* file = std::getenv("WAKE_LOG_FILE")) {
+            addFileSink(file, 1024 * 1024, 3);
+        }
+
+        running_ = true;
+        writer_ = std::thread(&Backend::run, this);
+        std::atexit([] { Backend::instance().shutdown(); });
+    }
+
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            stopping_ = true;
+        }
+        wake_cv_.notify_one();
+        if (writer_.joinable()) {
+            writer_.join();
+        }
+    }
+
+    void run() {
+        std::string batch;
+        batch.reserve(MAX_BATCH_BYTES + RECORD_SIZE);
+        uint64_t reported_drops = 0;
+
+        while (true) {
+            uint64_t records = 0;
+            while (batch.size() < MAX_BATCH_BYTES && queue_.tryPop(batch)) {
+                records++;
+            }
+
+            if (records > 0) {
+                {
+                    std::lock_guard<std::mutex> lock(sinks_mutex_);
+                    writeLocked(batch.data(), batch.size());
+                }
+                batch.clear();
+                written_.fetch_add(records, std::memory_order_release);
+                {
+                    std::lock_guard<std::mutex> lock(flush_mutex_);
+                }
+                flush_cv_.notify_all();
+                continue;
+            }
+
+            uint64_t drops = dropped_.load(std::memory_order_relaxed);
+            if (drops != reported_drops) {
+                char line[128];
+                int length = std::snprintf(line, sizeof(line),
+                                           "%s[WARN] %llu mensajes de log descartados (cola llena)\n",
+                                           timestampPrefix(),
+                                           static_cast<unsigned long long>(drops - reported_drops));
+                std::lock_guard<std::mutex> lock(sinks_mutex_);
+                writeLocked(line, static_cast<size_t>(length));
+                reported_drops = drops;
+            }
+
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            if (stopping_) break;
+            writer_idle_.store(true, std::memory_order_release);
+            if (queue_.empty()) {
+                wake_cv_.wait_for(lock, std::chrono::milliseconds(100));
+            }
+            writer_idle_.store(false, std::memory_order_release);
+        }
+
+        // Lo que se registre a partir de aquí se escribe directamente
+        running_.store(false, std::memory_order_release);
+        std::string rest;
+        while (queue_.tryPop(rest)) {}
+        std::lock_guard<std::mutex> lock(sinks_mutex_);
+        writeLocked(rest.data(), rest.size());
+    }
+
+    void writeLocked(const char* data, size_t size) {
+        if (size == 0) return;
+        if (console_.load(std::memory_order_relaxed)) {
+            writeAll(STDOUT_FILENO, data, size);
+        }
+        for (auto& sink : sinks_) {
+            if (sink.fd < 0) continue;
+            if (sink.size > 0 && sink.size + size > sink.max_bytes) {
+                sink.rotate();
+                if (sink.fd < 0) continue;
+            }
+            writeAll(sink.fd, data, size);
+            sink.size += size;
+        }
+    }
+
+    RingBuffer queue_;
+    std::atomic<int> level_{static_cast<int>(Logger::Level::Info)};
+    std::atomic<bool> console_{true};
+    std::atomic<bool> running_{false};
+    std::atomic<bool> writer_idle_{false};
+    std::atomic<uint64_t> enqueued_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    bool stopping_ = false;
+
+    std::mutex flush_mutex_;
+    std::condition_variable flush_cv_;
+
+    std::mutex sinks_mutex_;
+    std::vector<FileSink> sinks_;
+
+    std::thread writer_;
+};
+
+}
+
+void Logger::log(Level level, const std::string& message) {
+    Backend::instance().log(level, message);
+}
+
+void Logger::setLevel(Level level) {
+    Backend::instance().setLevel(level);
+}
+
+Logger::Level Logger::level() {
+    return Backend::instance().level();
+}
+
+void Logger::setConsole(bool enabled) {
+    Backend::instance().setConsole(enabled);
+}
+
+bool Logger::addFileSink(const std::string& path, size_t max_bytes, int max_files) {
+    return Backend::instance().addFileSink(path, max_bytes, max_files);
+}
+
+void Logger::flush() {
+    Backend::instance().flush();
+}
+
+Logger::Stats Logger::stats() {
+    return Backend::instance().stats();
+}
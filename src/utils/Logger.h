@@ -2,36 +2,55 @@
 #define LOGGER_H
 
 #include <string>
-#include <iostream>
-#include <chrono>
-#include <iomanip>
+#include <cstddef>
+#include <cstdint>
 
+// Log asíncrono: los hilos que registran sólo formatean la línea y la
+// encolan en un buffer circular sin bloqueos; un hilo de fondo la escribe
+// (por lotes) en consola y en los ficheros configurados.
+//
+// Configuración por entorno: WAKE_LOG_LEVEL=debug|info|warning|error,
+// WAKE_LOG_FILE=<ruta> (rotación por tamaño).
 class Logger {
 public:
+    enum class Level { Debug = 0, Info, Warning, Error };
+
+    struct Stats {
+        uint64_t written = 0;
+        uint64_t dropped = 0;  // cola llena: la línea se descarta
+    };
+
+    static void debug(const std::string& message) {
+        log(Level::Debug, message);
+    }
+
     static void info(const std::string& message) {
-        log("INFO", message);
+        log(Level::Info, message);
     }
-    
+
     static void warning(const std::string& message) {
-        log("WARN", message);
+        log(Level::Warning, message);
     }
-    
+
     static void error(const std::string& message) {
-        log("ERROR", message);
+        log(Level::Error, message);
     }
-    
+
+    static void setLevel(Level level);
+    static Level level();
+    static void setConsole(bool enabled);
+
+    // Añade un fichero de log; al superar max_bytes se rota a path.1,
+    // path.2... conservando max_files ficheros antiguos
+    static bool addFileSink(const std::string& path, size_t max_bytes = 1024 * 1024,
+                            int max_files = 3);
+
+    // Espera a que todo lo registrado hasta ahora esté escrito
+    static void flush();
+    static Stats stats();
+
 private:
-    static void log(const std::string& level, const std::string& message) {
-        auto now = std::chrono::system_clock::now();
-        auto now_t = std::chrono::system_clock::to_time_t(now);
-        auto local_tm = std::localtime(&now_t);
-        
-        std::cout << "["
-                  << std::setfill('0') << std::setw(2) << local_tm->tm_hour << ":"
-                  << std::setfill('0') << std::setw(2) << local_tm->tm_min << ":"
-                  << std::setfill('0') << std::setw(2) << local_tm->tm_sec
-                  << "] [" << level << "] " << message << std::endl;
-    }
+    static void log(Level level, const std::string& message);
 };
 
-#endif
\ No newline at end of file
+#endif
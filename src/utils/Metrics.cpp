@@ -0,0 +1,181 @@
+#include "Metrics.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+uint64_t toBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double fromBits(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void appendNumber(std::string& out, double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    out += buffer;
+}
+
+// name{labels,extra} o name{extra} o name
+void appendSeries(std::string& out, const std::string& name, const std::string& labels,
+                  const std::string& extra = "") {
+    out += name;
+    if (!labels.empty() || !extra.empty()) {
+        out += '{';
+        out += labels;
+        if (!labels.empty() && !extra.empty()) out += ',';
+        out += extra;
+        out += '}';
+    }
+    out += ' ';
+}
+
+}
+
+Histogram::Histogram(std::vector<double> bounds)
+    : bounds_(std::move(bounds)),
+      buckets_(new std::atomic<uint64_t>[bounds_.size() + 1]) {
+    std::sort(bounds_.begin(), bounds_.end());
+    for (size_t i = 0; i <= bounds_.size(); i++) {
+        buckets_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::observe(double value) {
+    // Los cubos se guardan sin acumular; se suman al generar la salida
+    size_t bucket = std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin();
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t old_bits = sum_bits_.load(std::memory_order_relaxed);
+    while (!sum_bits_.compare_exchange_weak(old_bits, toBits(fromBits(old_bits) + value),
+                                            std::memory_order_relaxed)) {}
+}
+
+double Histogram::sum() const {
+    return fromBits(sum_bits_.load(std::memory_order_relaxed));
+}
+
+std::vector<double> Histogram::latencyBuckets() {
+    return {0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01,
+            0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+}
+
+std::mutex& Metrics::mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::map<std::string, Metrics::Family>& Metrics::families() {
+    static std::map<std::string, Family> families;
+    return families;
+}
+
+Metrics::Family& Metrics::family(const std::string& name, const std::string& help, const char* type) {
+    Family& family = families()[name];
+    if (family.type.empty()) {
+        family.help = help;
+        family.type = type;
+    } else if (family.type != type) {
+        Logger::error("Métrica " + name + " registrada con tipos distintos");
+    }
+    return family;
+}
+
+Counter& Metrics::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex());
+    auto& slot = family(name, help, "counter").counters[labels];
+    if (!slot) slot = std::make_unique<Counter>();
+    return *slot;
+}
+
+Histogram& Metrics::histogram(const std::string& name, const std::string& help,
+                              const std::string& labels, std::vector<double> bounds) {
+    std::lock_guard<std::mutex> lock(mutex());
+    auto& slot = family(name, help, "histogram").histograms[labels];
+    if (!slot) slot = std::make_unique<Histogram>(std::move(bounds));
+    return *slot;
+}
+
+void Metrics::gauge(const std::string& name, const std::string& help,
+                    const std::string& labels, std::function<double()> read) {
+    std::lock_guard<std::mutex> lock(mutex());
+    family(name, help, "gauge").gauges[labels] = std::move(read);
+}
+
+std::string Metrics::renderPrometheus() {
+    // Los gauges se leen sin el mutex del registro: sus funciones pueden
+    // tomar otros locks (p.ej. el de AlarmManager) y quien tiene esos locks
+    // puede estar registrando una métrica
+    std::vector<std::pair<std::string, std::function<double()>>> readers;
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        for (const auto& [name, family] : families()) {
+            for (const auto& [labels, read] : family.gauges) {
+                readers.emplace_back(name + "{" + labels + "}", read);
+            }
+        }
+    }
+    std::map<std::string, double> gauge_values;
+    for (const auto& [key, read] : readers) {
+        gauge_values[key] = read();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex());
+    std::string out;
+    out.reserve(16 * 1024);
+
+    for (const auto& [name, family] : families()) {
+        out += "# HELP " + name + " " + family.help + "\n";
+        out += "# TYPE " + name + " " + family.type + "\n";
+
+        for (const auto& [labels, counter] : family.counters) {
+            appendSeries(out, name, labels);
+            out += std::to_string(counter->value());
+            out += '\n';
+        }
+
+        for (const auto& gauge : family.gauges) {
+            auto value = gauge_values.find(name + "{" + gauge.first + "}");
+            if (value == gauge_values.end()) continue;
+            appendSeries(out, name, gauge.first);
+            appendNumber(out, value->second);
+            out += '\n';
+        }
+
+        for (const auto& [labels, histogram] : family.histograms) {
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i <= histogram->bounds_.size(); i++) {
+                cumulative += histogram->buckets_[i].load(std::memory_order_relaxed);
+                std::string le = "le=\"";
+                if (i < histogram->bounds_.size()) {
+                    char bound[32];
+                    std::snprintf(bound, sizeof(bound), "%.9g", histogram->bounds_[i]);
+                    le += bound;
+                } else {
+                    le += "+Inf";
+                }
+                le += '"';
+                appendSeries(out, name + "_bucket", labels, le);
+                out += std::to_string(cumulative);
+                out += '\n';
+            }
+            appendSeries(out, name + "_sum", labels);
+            appendNumber(out, fromBits(histogram->sum_bits_.load(std::memory_order_relaxed)));
+            out += '\n';
+            appendSeries(out, name + "_count", labels);
+            out += std::to_string(histogram->count_.load(std::memory_order_relaxed));
+            out += '\n';
+        }
+    }
+
+    return out;
+}
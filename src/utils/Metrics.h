@@ -0,0 +1,91 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Métricas en formato de texto de Prometheus (GET /metrics).
+// Los valores son atómicos relajados: registrar cuesta un fetch_add y se
+// puede dejar siempre activo. Los objetos se crean una vez (registro con
+// mutex) y quien los usa guarda la referencia, p.ej. en un static local.
+class Counter {
+public:
+    void inc(uint64_t amount = 1) { value_.fetch_add(amount, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+class Histogram {
+public:
+    explicit Histogram(std::vector<double> bounds);
+
+    void observe(double value);
+    void observe(std::chrono::steady_clock::duration elapsed) {
+        observe(std::chrono::duration<double>(elapsed).count());
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    double sum() const;
+
+    // Cubos de latencia en segundos, de 50 µs a 10 s
+    static std::vector<double> latencyBuckets();
+
+private:
+    friend class Metrics;
+
+    std::vector<double> bounds_;
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets_;  // bounds_.size() + 1 (+Inf)
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_bits_{0};  // double guardado como bits
+};
+
+// Mide desde la construcción hasta la destrucción
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram_(histogram), started_(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() { histogram_.observe(std::chrono::steady_clock::now() - started_); }
+
+private:
+    Histogram& histogram_;
+    std::chrono::steady_clock::time_point started_;
+};
+
+class Metrics {
+public:
+    // labels en formato Prometheus sin llaves: route="/api/alarms",method="GET"
+    static Counter& counter(const std::string& name, const std::string& help,
+                            const std::string& labels = "");
+    static Histogram& histogram(const std::string& name, const std::string& help,
+                                const std::string& labels = "",
+                                std::vector<double> bounds = Histogram::latencyBuckets());
+    // Valor calculado al generar la salida
+    static void gauge(const std::string& name, const std::string& help,
+                      const std::string& labels, std::function<double()> read);
+
+    static std::string renderPrometheus();
+
+private:
+    struct Family {
+        std::string help;
+        std::string type;
+        std::map<std::string, std::unique_ptr<Counter>> counters;
+        std::map<std::string, std::unique_ptr<Histogram>> histograms;
+        std::map<std::string, std::function<double()>> gauges;
+    };
+
+    static std::mutex& mutex();
+    static std::map<std::string, Family>& families();
+    static Family& family(const std::string& name, const std::string& help, const char* type);
+};
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef PROCESS_H
+#define PROCESS_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+// Lanzamiento de procesos auxiliares sin pasar por una shell
+class Process {
+public:
+    // Busca un ejecutable en el PATH (sin lanzar nada); "" si no existe
+    static std::string findExecutable(const std::string& name);
+
+    // Ejecuta argv con posix_spawnp, con stdin/stdout/stderr en /dev/null,
+    // y espera a que termine. Devuelve el código de salida, o -1 si no se
+    // pudo lanzar, terminó por señal o superó el timeout (se mata).
+    static int run(const std::vector<std::string>& argv,
+                   std::chrono::milliseconds timeout = std::chrono::seconds(10));
+};
+
+#endif
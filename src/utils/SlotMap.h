@@ -0,0 +1,124 @@
+#ifndef SLOT_MAP_H
+#define SLOT_MAP_H
+
+#include <cstdint>
+#include <vector>
+
+// Handle compacto a un elemento de SlotMap. La generación cambia cada vez
+// que el slot se reutiliza, así que un handle de un elemento borrado deja
+// de ser válido aunque su índice vuelva a ocuparse.
+struct SlotHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+    
+    bool operator==(const SlotHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+};
+
+// Contenedor con inserción, borrado y acceso O(1) por handle.
+// Los valores viven contiguos en un vector (recorrido cache-friendly);
+// borrar mueve el último elemento al hueco (swap-and-pop), por lo que el
+// orden de iteración no es estable.
+template <typename T>
+class SlotMap {
+public:
+    SlotHandle insert(T value) {
+        uint32_t slot_index;
+        if (!free_slots_.empty()) {
+            slot_index = free_slots_.back();
+            free_slots_.pop_back();
+        } else {
+            slot_index = static_cast<uint32_t>(slots_.size());
+            slots_.push_back(Slot{});
+        }
+        
+        Slot& slot = slots_[slot_index];
+        slot.dense_index = static_cast<uint32_t>(values_.size());
+        values_.push_back(std::move(value));
+        dense_to_slot_.push_back(slot_index);
+        
+        return SlotHandle{slot_index, slot.generation};
+    }
+    
+    bool erase(SlotHandle handle) {
+        if (!contains(handle)) return false;
+        
+        Slot& slot = slots_[handle.index];
+        uint32_t hole = slot.dense_index;
+        uint32_t last = static_cast<uint32_t>(values_.size() - 1);
+        
+        if (hole != last) {
+            values_[hole] = std::move(values_[last]);
+            dense_to_slot_[hole] = dense_to_slot_[last];
+            slots_[dense_to_slot_[hole]].dense_index = hole;
+        }
+        values_.pop_back();
+        dense_to_slot_.pop_back();
+        
+        slot.generation++;
+        slot.dense_index = UINT32_MAX;
+        free_slots_.push_back(handle.index);
+        return true;
+    }
+    
+    bool contains(SlotHandle handle) const {
+        return handle.index < slots_.size() &&
+               slots_[handle.index].generation == handle.generation &&
+               slots_[handle.index].dense_index != UINT32_MAX;
+    }
+    
+    T* get(SlotHandle handle) {
+        return contains(handle) ? &values_[slots_[handle.index].dense_index] : nullptr;
+    }
+    
+    const T* get(SlotHandle handle) const {
+        return contains(handle) ? &values_[slots_[handle.index].dense_index] : nullptr;
+    }
+    
+    // Handle del elemento en la posición densa `dense_index`
+    SlotHandle handleAt(size_t dense_index) const {
+        uint32_t slot_index = dense_to_slot_[dense_index];
+        return SlotHandle{slot_index, slots_[slot_index].generation};
+    }
+    
+    void clear() {
+        for (uint32_t slot_index : dense_to_slot_) {
+            slots_[slot_index].generation++;
+            slots_[slot_index].dense_index = UINT32_MAX;
+            free_slots_.push_back(slot_index);
+        }
+        values_.clear();
+        dense_to_slot_.clear();
+    }
+    
+    void reserve(size_t n) {
+        values_.reserve(n);
+        dense_to_slot_.reserve(n);
+        slots_.reserve(n);
+    }
+    
+    size_t size() const { return values_.size(); }
+    bool empty() const { return values_.empty(); }
+    
+    const std::vector<T>& values() const { return values_; }
+    
+    typename std::vector<T>::iterator begin() { return values_.begin(); }
+    typename std::vector<T>::iterator end() { return values_.end(); }
+    typename std::vector<T>::const_iterator begin() const { return values_.begin(); }
+    typename std::vector<T>::const_iterator end() const { return values_.end(); }
+
+private:
+    struct Slot {
+        uint32_t dense_index = UINT32_MAX;
+        uint32_t generation = 0;
+    };
+    
+    std::vector<T> values_;
+    std::vector<uint32_t> dense_to_slot_;
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> free_slots_;
+};
+
+#endif
@@ -2,6 +2,8 @@
 #define TIME_UTILS_H
 
 #include <string>
+#include <ctime>
+#include "Clock.h"
 
 struct CurrentTime {
     int hour;
@@ -11,8 +13,7 @@ struct CurrentTime {
 
 class TimeUtils {
 public:
-    static CurrentTime getCurrentTime();
-    static std::string generateUUID();
+    static CurrentTime getCurrentTime(const Clock& clock = *Clock::system());
     static std::string formatTime(int hour, int minute);
 };
 
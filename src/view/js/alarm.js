@@ -1,5 +1,8 @@
 let alarms = [];
 let statusCheckInterval = null;
+let eventSource = null;
+let ringingAlarmId = null; // alarma que suena (la más reciente si hay varias)
+let ringingAlarmNs = null; // su namespace, si no es el de por defecto
 
 // Elementos DOM
 const currentTimeEl = document.getElementById('currentTime');
@@ -7,21 +10,24 @@ const hourInput = document.getElementById('hourInput');
 const minuteInput = document.getElementById('minuteInput');
 const labelInput = document.getElementById('labelInput');
 const vibrateCheck = document.getElementById('vibrateCheck');
+const weekdayChecks = document.querySelectorAll('#weekdayPicker input');
 const createBtn = document.getElementById('createBtn');
 const alarmsListEl = document.getElementById('alarmsList');
 const alarmRingingEl = document.getElementById('alarmRinging');
 const ringLabelEl = document.getElementById('ringLabel');
 const stopAlarmBtn = document.getElementById('stopAlarmBtn');
+const snoozeAlarmBtn = document.getElementById('snoozeAlarmBtn');
 
 // Inicialización
 document.addEventListener('DOMContentLoaded', () => {
     updateCurrentTime();
     setInterval(updateCurrentTime, 1000);
     loadAlarms();
-    startStatusChecker(); // Cambio: solo verificar estado del servidor
+    startEventStream(); // Eventos del servidor (con sondeo como respaldo)
     
     createBtn.addEventListener('click', createAlarm);
     stopAlarmBtn.addEventListener('click', stopAlarm);
+    snoozeAlarmBtn.addEventListener('click', snoozeAlarm);
     
     // Validación de inputs
     hourInput.addEventListener('input', () => {
@@ -50,6 +56,8 @@ async function loadAlarms() {
         if (!response.ok) throw new Error('Error al cargar alarmas');
         
         alarms = await response.json();
+        // El servidor no garantiza orden (borrado swap-and-pop): ordenar por hora
+        alarms.sort((a, b) => (a.hour * 60 + a.minute) - (b.hour * 60 + b.minute));
         renderAlarms();
     } catch (error) {
         console.error('Error:', error);
@@ -80,6 +88,7 @@ function renderAlarms() {
                     ${alarm.label}${alarm.vibrate ? ' 📳' : ''}
                     ${alarm.ringing ? ' 🔔' : ''}
                 </div>
+                <div class="alarm-repeat">${describeRepeat(alarm)}</div>
             </div>
             <div class="alarm-controls">
                 <button class="btn-toggle ${alarm.enabled ? 'active' : ''}" 
@@ -96,12 +105,39 @@ function renderAlarms() {
     });
 }
 
+const WEEKDAY_NAMES = ['Dom', 'Lun', 'Mar', 'Mié', 'Jue', 'Vie', 'Sáb'];
+
+// Texto de la regla de repetición y del próximo disparo
+function describeRepeat(alarm) {
+    const repeat = alarm.repeat || { type: 'daily' };
+    let text;
+    if (repeat.type === 'weekly') {
+        text = repeat.weekdays.map(day => WEEKDAY_NAMES[day]).join(', ');
+    } else if (repeat.type === 'dates') {
+        text = repeat.dates.join(', ');
+    } else if (repeat.type === 'interval') {
+        text = `Cada ${repeat.every_days} días`;
+    } else {
+        text = 'Todos los días';
+    }
+    
+    if (alarm.enabled && alarm.next_fire) {
+        const next = new Date(alarm.next_fire * 1000);
+        text += ` · próxima: ${next.toLocaleDateString()} ${next.toLocaleTimeString([], { hour: '2-digit', minute: '2-digit' })}`;
+    }
+    return text;
+}
+
 // Crear nueva alarma
 async function createAlarm() {
     const hour = parseInt(hourInput.value);
     const minute = parseInt(minuteInput.value);
     const label = labelInput.value.trim() || 'Alarma';
     const vibrate = vibrateCheck.checked;
+    // Sin días marcados: todos los días
+    const weekdays = Array.from(weekdayChecks)
+        .filter(check => check.checked)
+        .map(check => parseInt(check.value));
     
     if (isNaN(hour) || isNaN(minute)) {
         showNotification('Por favor ingresa una hora válida', 'error');
@@ -112,7 +148,9 @@ async function createAlarm() {
         const response = await fetch('/api/alarms', {
             method: 'POST',
             headers: { 'Content-Type': 'application/json' },
-            body: JSON.stringify({ hour, minute, label, vibrate })
+            body: JSON.stringify(weekdays.length > 0
+                ? { hour, minute, label, vibrate, repeat: { type: 'weekly', weekdays } }
+                : { hour, minute, label, vibrate })
         });
         
         if (!response.ok) throw new Error('Error al crear alarma');
@@ -126,6 +164,7 @@ async function createAlarm() {
             // Reset form
             labelInput.value = '';
             vibrateCheck.checked = true;
+            weekdayChecks.forEach(check => { check.checked = false; });
         }
     } catch (error) {
         console.error('Error:', error);
@@ -177,17 +216,20 @@ async function deleteAlarm(id) {
     }
 }
 
-// Detener alarma sonando
+// Detener alarma sonando (si suenan varias, sólo la que se muestra)
 async function stopAlarm() {
     try {
-        const response = await fetch('/api/alarms/stop', {
+        const url = ringingAlarmId
+            ? `${ringingAlarmUrl()}/stop`
+            : '/api/alarms/stop';
+        const response = await fetch(url, {
             method: 'POST'
         });
         
         if (!response.ok) throw new Error('Error al detener alarma');
         
-        alarmRingingEl.classList.add('hidden');
         showNotification('Alarma detenida', 'success');
+        checkStatus(); // Puede quedar otra sonando
         loadAlarms(); // Recargar para actualizar estado
     } catch (error) {
         console.error('Error:', error);
@@ -195,32 +237,107 @@ async function stopAlarm() {
     }
 }
 
-// NUEVO: Verificar estado del servidor (si hay alarma sonando)
-function startStatusChecker() {
-    statusCheckInterval = setInterval(async () => {
-        try {
-            const response = await fetch('/api/alarms/status');
-            if (!response.ok) return;
-            
-            const status = await response.json();
-            
-            if (status.ringing && alarmRingingEl.classList.contains('hidden')) {
-                // Mostrar UI de alarma sonando
-                ringLabelEl.textContent = status.label || 'Alarma';
-                alarmRingingEl.classList.remove('hidden');
-                
-                // NO reproducir audio aquí - el servidor ya lo está haciendo
-                console.log('🔔 Alarma sonando en el servidor:', status.label);
-                
-            } else if (!status.ringing && !alarmRingingEl.classList.contains('hidden')) {
-                // Ocultar UI si se detuvo
-                alarmRingingEl.classList.add('hidden');
-            }
-            
-        } catch (error) {
-            console.error('Error verificando estado:', error);
+// Posponer la alarma que se muestra; vuelve a sonar sola
+async function snoozeAlarm() {
+    if (!ringingAlarmId) return;
+    
+    try {
+        const response = await fetch(`${ringingAlarmUrl()}/snooze`, {
+            method: 'POST'
+        });
+        
+        if (!response.ok) throw new Error('Error al posponer alarma');
+        
+        showNotification('Alarma pospuesta', 'success');
+        checkStatus();
+    } catch (error) {
+        console.error('Error:', error);
+        showNotification('Error al posponer alarma', 'error');
+    }
+}
+
+// Ruta de la alarma que suena: puede ser de otro namespace (/api/u/:user)
+function ringingAlarmUrl() {
+    const base = ringingAlarmNs ? `/api/u/${encodeURIComponent(ringingAlarmNs)}/alarms` : '/api/alarms';
+    return `${base}/${encodeURIComponent(ringingAlarmId)}`;
+}
+
+// Mostrar u ocultar la UI de alarma sonando según el estado del servidor
+function applyRingingStatus(status) {
+    ringingAlarmId = status.ringing ? (status.id || null) : null;
+    ringingAlarmNs = status.ringing ? (status.ns || null) : null;
+    
+    if (status.ringing) {
+        ringLabelEl.textContent = status.label || 'Alarma';
+    }
+    
+    if (status.ringing && alarmRingingEl.classList.contains('hidden')) {
+        // Mostrar UI de alarma sonando
+        alarmRingingEl.classList.remove('hidden');
+        
+        // NO reproducir audio aquí - el servidor ya lo está haciendo
+        console.log('🔔 Alarma sonando en el servidor:', status.label);
+        
+    } else if (!status.ringing && !alarmRingingEl.classList.contains('hidden')) {
+        // Ocultar UI si se detuvo
+        alarmRingingEl.classList.add('hidden');
+    }
+}
+
+// Recibir eventos del servidor por SSE: sin peticiones mientras no pase nada
+function startEventStream() {
+    if (!('EventSource' in window)) {
+        startStatusChecker();
+        return;
+    }
+    
+    eventSource = new EventSource('/api/events');
+    
+    eventSource.addEventListener('status', (e) => applyRingingStatus(JSON.parse(e.data)));
+    // Los eventos de alarma traen el estado global tras el cambio
+    const applyRingEvent = (e) => {
+        const event = JSON.parse(e.data);
+        applyRingingStatus({ ringing: event.ringing, id: event.current, ns: event.current_ns, label: event.current_label });
+    };
+    eventSource.addEventListener('alarm-fired', applyRingEvent);
+    eventSource.addEventListener('alarm-stopped', applyRingEvent);
+    eventSource.addEventListener('alarm-snoozed', applyRingEvent);
+    // Esta página sólo muestra el namespace por defecto
+    eventSource.addEventListener('list-changed', (e) => {
+        if (!JSON.parse(e.data).ns) loadAlarms();
+    });
+    eventSource.addEventListener('resync', () => {
+        loadAlarms();
+        checkStatus();
+    });
+    
+    eventSource.onerror = () => {
+        // EventSource reintenta solo; si el servidor lo rechaza (503) queda
+        // cerrado y pasamos a sondear
+        if (eventSource.readyState === EventSource.CLOSED) {
+            console.log('SSE no disponible, usando sondeo');
+            eventSource = null;
+            startStatusChecker();
         }
-    }, 2000); // Verificar cada 2 segundos
+    };
+}
+
+// Consultar una vez el estado de la alarma
+async function checkStatus() {
+    try {
+        const response = await fetch('/api/alarms/status');
+        if (!response.ok) return;
+        
+        applyRingingStatus(await response.json());
+    } catch (error) {
+        console.error('Error verificando estado:', error);
+    }
+}
+
+// Respaldo: verificar estado del servidor periódicamente
+function startStatusChecker() {
+    if (statusCheckInterval) return;
+    statusCheckInterval = setInterval(checkStatus, 2000); // Verificar cada 2 segundos
 }
 
 // Mostrar notificación
@@ -0,0 +1,65 @@
+#include "Test.h"
+#include "core/AudioPlayer.h"
+#include <chrono>
+#include <functional>
+#include <thread>
+
+namespace {
+
+bool waitFor(const std::function<bool()>& done) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+size_t countOf(const std::vector<std::string>& events, const std::string& event) {
+    size_t count = 0;
+    for (const auto& e : events) count += (e == event);
+    return count;
+}
+
+}
+
+WAKE_TEST(audio, arm_play_stop_sequence) {
+    auto recorder = std::make_shared<RecordingAudioBackend>();
+    // x1000: los 1,5 s entre pitidos son 1,5 ms reales
+    auto clock = std::make_shared<SimulatedClock>(std::chrono::system_clock::now(), 1000.0);
+    AudioPlayer player(recorder, clock);
+
+    player.arm("campana.mp3");
+    WAKE_REQUIRE(waitFor([&] { return !recorder->events().empty(); }));
+
+    player.play("campana.mp3", true);
+    WAKE_REQUIRE(waitFor([&] { return countOf(recorder->events(), "beep:campana.mp3") >= 3; }));
+    player.stop();
+    WAKE_CHECK(!player.isPlaying());
+
+    // Vibra en pitidos alternos, empezando por el primero
+    const std::vector<std::string> expected = {
+        "prepare:campana.mp3",
+        "beep:campana.mp3", "vibrate:500",
+        "beep:campana.mp3",
+        "beep:campana.mp3", "vibrate:500",
+    };
+    std::vector<std::string> events = recorder->events();
+    WAKE_REQUIRE(events.size() >= expected.size());
+    WAKE_CHECK(std::vector<std::string>(events.begin(), events.begin() + expected.size()) == expected);
+    WAKE_CHECK(player.latencyStats().samples == 1);
+    WAKE_CHECK(player.latencyStats().last_armed);
+
+    // Tras stop() no suena nada más
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    WAKE_CHECK(recorder->events() == events);
+
+    // Sin vibración y sin pre-armar: sólo pitidos
+    recorder->clear();
+    player.play("otro.mp3", false);
+    WAKE_REQUIRE(waitFor([&] { return countOf(recorder->events(), "beep:otro.mp3") >= 2; }));
+    player.stop();
+    events = recorder->events();
+    WAKE_CHECK(countOf(events, "beep:otro.mp3") == events.size());
+    WAKE_CHECK(!player.latencyStats().last_armed);
+}
@@ -0,0 +1,53 @@
+#include "Test.h"
+#include "models/AlarmCodec.h"
+#include <nlohmann/json.hpp>
+
+WAKE_TEST(codec, round_trip_with_nlohmann) {
+    // Lo que escribía la versión con nlohmann: claves en otro orden,
+    // escapes y UTF-8 en la etiqueta
+    nlohmann::json original = {
+        {"repeat", {{"type", "weekly"}, {"weekdays", {1, 3, 5}}, {"except", {"2026-12-25"}}}},
+        {"sound_file", "campana.mp3"},
+        {"vibrate", false},
+        {"enabled", true},
+        {"label", "Café \"temprano\"\n\t\\ ☕"},
+        {"minute", 5},
+        {"hour", 6},
+        {"id", AlarmId(0xabcdef).toString()},
+    };
+
+    AlarmFields fields;
+    std::string error;
+    WAKE_REQUIRE(AlarmCodec::parse(original.dump(), fields, nullptr, error));
+    Alarm alarm;
+    WAKE_REQUIRE(AlarmCodec::toAlarm(std::move(fields), alarm, error));
+    WAKE_CHECK(alarm.id == AlarmId(0xabcdef));
+    WAKE_CHECK(alarm.hour == 6 && alarm.minute == 5);
+    WAKE_CHECK(*alarm.label == original["label"].get<std::string>());
+
+    std::string written;
+    AlarmCodec::appendObject(written, alarm, AlarmCodec::FIELDS);
+    nlohmann::json reparsed = nlohmann::json::parse(written, nullptr, false);
+    WAKE_REQUIRE(!reparsed.is_discarded());
+    WAKE_CHECK(reparsed == original);
+
+    // Mismos bytes que dump() para los textos
+    WAKE_CHECK(written.find(original["label"].dump()) != std::string::npos);
+}
+
+WAKE_TEST(codec, rejects_invalid_fields) {
+    AlarmFields fields;
+    std::string error;
+    WAKE_CHECK(!AlarmCodec::parse(R"({"hour":24,"minute":0})", fields, nullptr, error));
+    WAKE_CHECK(!AlarmCodec::parse(R"({"hour":7,"minute":60})", fields, nullptr, error));
+    WAKE_CHECK(!AlarmCodec::parse(R"({"hour":"7"})", fields, nullptr, error));
+    WAKE_CHECK(!AlarmCodec::parse(R"({"hour":7,})", fields, nullptr, error));
+    WAKE_CHECK(!AlarmCodec::parse(R"({"repeat":{"type":"weekly","weekdays":[7]}})", fields,
+                                  nullptr, error));
+
+    // Sin id no es una alarma guardada
+    AlarmFields partial;
+    WAKE_REQUIRE(AlarmCodec::parse(R"({"hour":7,"minute":0})", partial, nullptr, error));
+    Alarm alarm;
+    WAKE_CHECK(!AlarmCodec::toAlarm(std::move(partial), alarm, error));
+}
@@ -0,0 +1,80 @@
+#include "Test.h"
+#include "core/AlarmManager.h"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+
+namespace {
+
+AlarmManager::Options testOptions(const std::string& dir) {
+    AlarmManager::Options options;
+    options.storage_path = dir + "/alarms";
+    options.audio_backend = std::make_shared<RecordingAudioBackend>();
+    options.wakelock.enabled = false;
+    return options;
+}
+
+bool exists(const std::string& path) {
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0;
+}
+
+}
+
+WAKE_TEST(lists, published_before_list_changed) {
+    wake_test::TempDir dir;
+    AlarmManager manager(testOptions(dir.path()));
+
+    auto initial = manager.getAlarmListSnapshot();
+    WAKE_REQUIRE(initial != nullptr);
+    WAKE_CHECK(initial->json == "[]");
+    // Sin cambios, leerla devuelve siempre la misma copia
+    WAKE_CHECK(manager.getAlarmListSnapshot() == initial);
+
+    auto events = manager.events().subscribe();
+    WAKE_REQUIRE(events != nullptr);
+    const std::string id = manager.createAlarm(7, 30, "Trabajo", true, "default");
+    WAKE_CHECK(manager.getAllAlarms().size() == 1);
+
+    // list-changed sólo se emite con la nueva lista ya publicada
+    std::string chunk;
+    bool changed = false;
+    for (int i = 0; i < 50 && !changed; i++) {
+        WAKE_REQUIRE(events->next(chunk, std::chrono::milliseconds(100)));
+        changed = chunk.find("list-changed") != std::string::npos;
+    }
+    WAKE_REQUIRE(changed);
+
+    auto published = manager.getAlarmListSnapshot();
+    WAKE_CHECK(published->version > initial->version);
+    WAKE_CHECK(published->json.find(id) != std::string::npos);
+    WAKE_CHECK(published->etag != initial->etag);
+    WAKE_CHECK(chunk.find("\"version\":" + std::to_string(published->version)) != std::string::npos);
+}
+
+WAKE_TEST(namespaces, first_use_creates_one_shard) {
+    wake_test::TempDir dir;
+    AlarmManager manager(testOptions(dir.path()));
+
+    // Leer un namespace desconocido no crea nada
+    WAKE_CHECK(manager.getAlarmListSnapshot("equipo")->json == "[]");
+    WAKE_CHECK(manager.getAllAlarms("equipo").empty());
+    WAKE_CHECK(!exists(dir.path() + "/alarms.ns"));
+    WAKE_CHECK(manager.getLoadedNamespaceCount() == 1);
+
+    // Varios hilos a la vez en un namespace nuevo acaban en el mismo shard
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; i++) {
+        threads.emplace_back([&manager, i] {
+            manager.createAlarm("equipo", 7, i, "Alarma " + std::to_string(i), true, "default");
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    WAKE_CHECK(manager.getAllAlarms("equipo").size() == 8);
+    WAKE_CHECK(manager.getLoadedNamespaceCount() == 2);
+    WAKE_CHECK(manager.flush());
+    WAKE_CHECK(exists(dir.path() + "/alarms.ns/equipo.journal"));
+}
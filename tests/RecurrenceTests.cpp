@@ -0,0 +1,74 @@
+#include "Test.h"
+#include "models/Recurrence.h"
+#include <cstdlib>
+#include <ctime>
+#include <string>
+
+namespace {
+
+// Zona con horario de verano europeo (último domingo de marzo a las 2:00
+// y último de octubre a las 3:00) sin depender de tzdata
+class ScopedTimeZone {
+public:
+    explicit ScopedTimeZone(const char* tz) {
+        const char* old = std::getenv("TZ");
+        had_old_ = old != nullptr;
+        if (had_old_) old_ = old;
+        ::setenv("TZ", tz, 1);
+        ::tzset();
+    }
+    ~ScopedTimeZone() {
+        if (had_old_) {
+            ::setenv("TZ", old_.c_str(), 1);
+        } else {
+            ::unsetenv("TZ");
+        }
+        ::tzset();
+    }
+
+private:
+    bool had_old_ = false;
+    std::string old_;
+};
+
+std::time_t localTime(int year, int month, int day, int hour, int minute) {
+    std::tm local{};
+    local.tm_year = year - 1900;
+    local.tm_mon = month - 1;
+    local.tm_mday = day;
+    local.tm_hour = hour;
+    local.tm_min = minute;
+    local.tm_isdst = -1;
+    return std::mktime(&local);
+}
+
+}
+
+WAKE_TEST(recurrence, next_fire_across_dst) {
+    ScopedTimeZone tz("CET-1CEST,M3.5.0,M10.5.0/3");
+    Recurrence daily;
+
+    // 2026-03-29 es el cambio de primavera: de 07:00 a 07:00 hay 23 h
+    std::time_t saturday = localTime(2026, 3, 28, 7, 0);
+    std::time_t sunday = daily.nextFire(7, 0, saturday + 60);
+    WAKE_CHECK(sunday == localTime(2026, 3, 29, 7, 0));
+    WAKE_CHECK(sunday - saturday == 23 * 3600);
+    std::tm local{};
+    ::localtime_r(&sunday, &local);
+    WAKE_CHECK(local.tm_hour == 7 && local.tm_min == 0 && local.tm_isdst > 0);
+
+    // Las 02:30 de ese día no existen: suena a la siguiente hora válida
+    std::time_t skipped = daily.nextFire(2, 30, saturday + 60);
+    WAKE_CHECK(skipped == localTime(2026, 3, 29, 3, 30));
+
+    // Semanal (domingos) con el domingo del cambio exceptuado
+    Recurrence weekly;
+    weekly.type = Recurrence::Type::Weekly;
+    weekly.weekdays = 1 << 0;
+    WAKE_REQUIRE(Recurrence::parseDate("2026-03-29", weekly.exceptions.emplace_back()));
+    WAKE_CHECK(weekly.nextFire(7, 0, saturday) == localTime(2026, 4, 5, 7, 0));
+
+    // 2026-10-25: de vuelta a invierno, 25 h
+    std::time_t before = localTime(2026, 10, 24, 7, 0);
+    WAKE_CHECK(daily.nextFire(7, 0, before + 60) - before == 25 * 3600);
+}
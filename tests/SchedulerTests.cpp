@@ -0,0 +1,55 @@
+#include "Test.h"
+#include "core/AlarmScheduler.h"
+#include "utils/SlotMap.h"
+#include <string>
+
+WAKE_TEST(scheduler, pops_in_due_order_skipping_cancelled) {
+    SlotMap<int> slots;
+    SlotHandle a = slots.insert(1);
+    SlotHandle b = slots.insert(2);
+    SlotHandle c = slots.insert(3);
+
+    AlarmScheduler scheduler;
+    scheduler.schedule(a, 300);
+    scheduler.schedule(b, 100);
+    scheduler.schedule(c, 200);
+    scheduler.cancel(c);
+    // Reprogramar deja la entrada vieja (100) obsoleta en el heap
+    scheduler.schedule(b, 400);
+    WAKE_CHECK(scheduler.size() == 2);
+
+    std::time_t due = 0;
+    SlotHandle next;
+    WAKE_REQUIRE(scheduler.nextDue(due, next));
+    WAKE_CHECK(due == 300);
+    WAKE_CHECK(next == a);
+
+    WAKE_CHECK(scheduler.popDue(299).empty());
+    auto fired = scheduler.popDue(1000);
+    WAKE_REQUIRE(fired.size() == 2);
+    WAKE_CHECK(fired[0].alarm == a && fired[0].due == 300);
+    WAKE_CHECK(fired[1].alarm == b && fired[1].due == 400);
+    WAKE_CHECK(!scheduler.nextDue(due));
+    WAKE_CHECK(scheduler.size() == 0);
+}
+
+WAKE_TEST(slotmap, stale_handle_rejected_after_reuse) {
+    SlotMap<std::string> slots;
+    SlotHandle first = slots.insert("primera");
+    SlotHandle other = slots.insert("otra");
+    WAKE_REQUIRE(slots.erase(first));
+
+    // El hueco se reutiliza con otra generación
+    SlotHandle second = slots.insert("segunda");
+    WAKE_CHECK(second.index == first.index);
+    WAKE_CHECK(second.generation != first.generation);
+
+    WAKE_CHECK(!slots.contains(first));
+    WAKE_CHECK(slots.get(first) == nullptr);
+    WAKE_CHECK(!slots.erase(first));
+    WAKE_REQUIRE(slots.get(second) != nullptr);
+    WAKE_CHECK(*slots.get(second) == "segunda");
+    WAKE_REQUIRE(slots.get(other) != nullptr);
+    WAKE_CHECK(*slots.get(other) == "otra");
+    WAKE_CHECK(slots.size() == 2);
+}
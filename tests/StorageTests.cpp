@@ -0,0 +1,156 @@
+#include "Test.h"
+#include "models/AlarmSnapshot.h"
+#include "models/AlarmStorage.h"
+#include "utils/Hash.h"
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+
+namespace {
+
+Alarm makeAlarm(uint64_t id, int hour, int minute, const std::string& label) {
+    Alarm alarm;
+    alarm.id = AlarmId(id);
+    alarm.hour = static_cast<uint8_t>(hour);
+    alarm.minute = static_cast<uint8_t>(minute);
+    alarm.label = label;
+    alarm.sound_file = "default";
+    return alarm;
+}
+
+std::string putLine(uint64_t id, int hour, int minute) {
+    return "{\"op\":\"put\",\"id\":\"" + AlarmId(id).toString() + "\",\"hour\":" +
+           std::to_string(hour) + ",\"minute\":" + std::to_string(minute) + "}\n";
+}
+
+off_t fileSize(const std::string& path) {
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0 ? st.st_size : -1;
+}
+
+}
+
+WAKE_TEST(snapshot, round_trip) {
+    Alarm daily = makeAlarm(1, 7, 30, "Trabajo");
+    daily.vibrate = false;
+    Alarm weekly = makeAlarm(2, 23, 59, "Fin de semana");
+    weekly.enabled = false;
+    weekly.sound_file = "campana.mp3";
+    Recurrence rule;
+    rule.type = Recurrence::Type::Weekly;
+    rule.weekdays = (1 << 0) | (1 << 6);
+    WAKE_REQUIRE(Recurrence::parseDate("2026-12-26", rule.exceptions.emplace_back()));
+    weekly.repeat = rule;
+
+    const std::string data = AlarmSnapshot::encode({daily, weekly});
+    std::vector<Alarm> loaded;
+    std::string error;
+    WAKE_REQUIRE(AlarmSnapshot::decode(data.data(), data.size(), loaded, error));
+    WAKE_REQUIRE(loaded.size() == 2);
+
+    WAKE_CHECK(loaded[0].id == daily.id);
+    WAKE_CHECK(loaded[0].hour == 7 && loaded[0].minute == 30);
+    WAKE_CHECK(*loaded[0].label == "Trabajo");
+    WAKE_CHECK(loaded[0].enabled && !loaded[0].vibrate);
+    WAKE_CHECK(loaded[0].repeat->isDefault());
+
+    WAKE_CHECK(loaded[1].id == weekly.id);
+    WAKE_CHECK(loaded[1].hour == 23 && loaded[1].minute == 59);
+    WAKE_CHECK(*loaded[1].sound_file == "campana.mp3");
+    WAKE_CHECK(!loaded[1].enabled && loaded[1].vibrate);
+    WAKE_CHECK(*loaded[1].repeat == rule);
+}
+
+WAKE_TEST(snapshot, reads_v1_records) {
+    // v1: id como texto en la tabla de strings y sin regla de repetición
+    const std::string id = AlarmId(0x2a).toString();
+    const std::string strings = id + "Antigua" + "default";
+
+    AlarmSnapshot::RecordV1 record;
+    std::memset(&record, 0, sizeof(record));
+    record.id_offset = 0;
+    record.id_length = static_cast<uint32_t>(id.size());
+    record.label_offset = record.id_length;
+    record.label_length = 7;
+    record.sound_offset = record.label_offset + record.label_length;
+    record.sound_length = 7;
+    record.hour = 6;
+    record.minute = 15;
+    record.flags = AlarmSnapshot::FLAG_ENABLED;
+
+    AlarmSnapshot::Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, AlarmSnapshot::MAGIC, sizeof(AlarmSnapshot::MAGIC));
+    header.version = 1;
+    header.header_size = sizeof(header);
+    header.record_count = 1;
+    header.record_size = sizeof(record);
+    header.strings_offset = sizeof(header) + sizeof(record);
+    header.strings_size = strings.size();
+
+    std::string data(reinterpret_cast<const char*>(&header), sizeof(header));
+    data.append(reinterpret_cast<const char*>(&record), sizeof(record));
+    data += strings;
+    header.checksum = fnv1a64(data.data() + sizeof(header), data.size() - sizeof(header));
+    std::memcpy(&data[offsetof(AlarmSnapshot::Header, checksum)], &header.checksum,
+                sizeof(header.checksum));
+
+    std::vector<Alarm> loaded;
+    std::string error;
+    WAKE_REQUIRE(AlarmSnapshot::decode(data.data(), data.size(), loaded, error));
+    WAKE_REQUIRE(loaded.size() == 1);
+    WAKE_CHECK(loaded[0].id == AlarmId(0x2a));
+    WAKE_CHECK(*loaded[0].label == "Antigua");
+    WAKE_CHECK(loaded[0].hour == 6 && loaded[0].minute == 15);
+    WAKE_CHECK(loaded[0].enabled && !loaded[0].vibrate);
+    WAKE_CHECK(loaded[0].repeat->isDefault());
+}
+
+WAKE_TEST(snapshot, rejects_corrupt_and_out_of_range) {
+    std::vector<Alarm> loaded;
+    std::string error;
+
+    std::string data = AlarmSnapshot::encode({makeAlarm(1, 7, 30, "Trabajo")});
+    data.back() ^= 0x01;
+    WAKE_CHECK(!AlarmSnapshot::decode(data.data(), data.size(), loaded, error));
+    WAKE_CHECK(error == "checksum incorrecto");
+
+    // Checksum correcto pero valores imposibles
+    data = AlarmSnapshot::encode({makeAlarm(1, 24, 0, "Trabajo")});
+    WAKE_CHECK(!AlarmSnapshot::decode(data.data(), data.size(), loaded, error));
+    data = AlarmSnapshot::encode({makeAlarm(1, 7, 60, "Trabajo")});
+    WAKE_CHECK(!AlarmSnapshot::decode(data.data(), data.size(), loaded, error));
+
+    Alarm bad_mask = makeAlarm(1, 7, 30, "Trabajo");
+    Recurrence rule;
+    rule.type = Recurrence::Type::Weekly;
+    rule.weekdays = 0x80;
+    bad_mask.repeat = rule;
+    data = AlarmSnapshot::encode({bad_mask});
+    WAKE_CHECK(!AlarmSnapshot::decode(data.data(), data.size(), loaded, error));
+    WAKE_CHECK(loaded.empty());
+}
+
+WAKE_TEST(journal, replay_drops_torn_last_line) {
+    wake_test::TempDir dir;
+    const std::string base = dir.path() + "/alarms";
+    const std::string complete = putLine(1, 7, 0) + putLine(2, 8, 15) +
+                                 "{\"op\":\"del\",\"id\":\"" + AlarmId(1).toString() + "\"}\n";
+    {
+        std::ofstream journal(base + ".journal", std::ios::binary);
+        // El último append se cortó a media línea
+        journal << complete << "{\"op\":\"put\",\"id\":\"" << AlarmId(3).toString() << "\",\"ho";
+    }
+
+    std::vector<Alarm> alarms;
+    {
+        AlarmStorage storage(base);
+        alarms = storage.load();
+    }
+    WAKE_REQUIRE(alarms.size() == 1);
+    WAKE_CHECK(alarms[0].id == AlarmId(2));
+    WAKE_CHECK(alarms[0].hour == 8 && alarms[0].minute == 15);
+    // La cola rota se recorta para que el siguiente append no quede pegado
+    WAKE_CHECK(fileSize(base + ".journal") == static_cast<off_t>(complete.size()));
+}
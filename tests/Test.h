@@ -0,0 +1,76 @@
+#ifndef WAKE_TEST_H
+#define WAKE_TEST_H
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Pruebas mínimas sin framework. Cada caso se registra con
+// WAKE_TEST(suite, nombre) y wake_tests ejecuta los de una suite (o todos):
+// ctest lanza una vez por suite, ver CMakeLists.txt.
+//
+// WAKE_CHECK no aborta el caso: anota el fallo y sigue, para ver todos
+// los que haya. WAKE_REQUIRE sí sale del caso (lo siguiente depende de él).
+namespace wake_test {
+
+struct Case {
+    const char* suite;
+    const char* name;
+    std::function<void()> body;
+};
+
+inline std::vector<Case>& cases() {
+    static std::vector<Case> registry;
+    return registry;
+}
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+struct Registrar {
+    Registrar(const char* suite, const char* name, std::function<void()> body) {
+        cases().push_back({suite, name, std::move(body)});
+    }
+};
+
+inline bool check(bool ok, const char* expr, const char* file, int line) {
+    if (!ok) {
+        std::fprintf(stderr, "%s:%d: falla: %s\n", file, line, expr);
+        failures()++;
+    }
+    return ok;
+}
+
+// Directorio nuevo bajo /tmp; se borra al terminar el caso
+class TempDir {
+public:
+    TempDir();
+    ~TempDir();
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+}
+
+#define WAKE_TEST(suite, name)                                                    \
+    static void test_##suite##_##name();                                          \
+    static wake_test::Registrar registrar_##suite##_##name(#suite, #name,         \
+                                                           test_##suite##_##name); \
+    static void test_##suite##_##name()
+
+#define WAKE_CHECK(expr) wake_test::check(static_cast<bool>(expr), #expr, __FILE__, __LINE__)
+
+#define WAKE_REQUIRE(expr)                                                           \
+    do {                                                                             \
+        if (!WAKE_CHECK(expr)) return;                                               \
+    } while (0)
+
+#endif
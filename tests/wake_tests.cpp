@@ -0,0 +1,57 @@
+// Pruebas de los componentes de wake_server (ver Test.h).
+//
+//   wake_tests [suite]
+//
+// Sin argumento ejecuta todas las suites. Devuelve 0 si no falla ninguna
+// comprobación.
+#include "Test.h"
+#include "utils/Logger.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ftw.h>
+#include <unistd.h>
+
+namespace wake_test {
+
+TempDir::TempDir() {
+    char pattern[] = "/tmp/wake_tests.XXXXXX";
+    if (::mkdtemp(pattern) == nullptr) {
+        std::perror("mkdtemp");
+        std::exit(1);
+    }
+    path_ = pattern;
+}
+
+TempDir::~TempDir() {
+    ::nftw(path_.c_str(), [](const char* path, const struct stat*, int, struct FTW*) {
+        return ::remove(path);
+    }, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+}
+
+int main(int argc, char** argv) {
+    const char* suite = argc > 1 ? argv[1] : nullptr;
+
+    // Los avisos esperados (journal cortado, snapshot corrupto) no son fallos
+    Logger::setConsole(false);
+    Logger::setLevel(Logger::Level::Error);
+
+    size_t run = 0;
+    for (const auto& test : wake_test::cases()) {
+        if (suite && std::strcmp(suite, test.suite) != 0) continue;
+        const int before = wake_test::failures();
+        test.body();
+        run++;
+        std::printf("%s %s.%s\n", wake_test::failures() == before ? "ok  " : "FALLA",
+                    test.suite, test.name);
+    }
+
+    if (run == 0) {
+        std::fprintf(stderr, "No hay pruebas%s%s\n", suite ? " en " : "", suite ? suite : "");
+        return 1;
+    }
+    std::printf("%zu pruebas, %d comprobaciones fallidas\n", run, wake_test::failures());
+    return wake_test::failures() == 0 ? 0 : 1;
+}